@@ -0,0 +1,19 @@
+# Builds the core library first, then the command-line driver, the benchmarks and the GUI against it
+TEMPLATE = subdirs
+
+core.file = core.pro
+core.makefile = Makefile.core
+
+cli.file = cli.pro
+cli.makefile = Makefile.cli
+cli.depends = core
+
+bench.file = bench.pro
+bench.makefile = Makefile.bench
+bench.depends = core
+
+gui.file = main.pro
+gui.makefile = Makefile.gui
+gui.depends = core
+
+SUBDIRS = core cli bench gui
@@ -0,0 +1,266 @@
+#include "allpairs.h"
+#include "asyncjob.h"
+#include "metrics.h"
+#include <algorithm>
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int TILE = 64;
+
+// c[j] = min(c[j], a + b[j]) for j in [0, len)
+inline void minPlusRow(float* c, const float* b, float a, int len)
+{
+    int j = 0;
+#if defined(__AVX__)
+    __m256 va = _mm256_set1_ps(a);
+    for (; j + 8 <= len; j += 8) {
+        __m256 cand = _mm256_add_ps(va, _mm256_loadu_ps(b + j));
+        _mm256_storeu_ps(c + j, _mm256_min_ps(_mm256_loadu_ps(c + j), cand));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 va = _mm_set1_ps(a);
+    for (; j + 4 <= len; j += 4) {
+        __m128 cand = _mm_add_ps(va, _mm_loadu_ps(b + j));
+        _mm_storeu_ps(c + j, _mm_min_ps(_mm_loadu_ps(c + j), cand));
+    }
+#endif
+    for (; j < len; ++j) {
+        float cand = a + b[j];
+        if (cand < c[j]) c[j] = cand;
+    }
+}
+
+// Same as minPlusRow, and sets next[j] = hop wherever c[j] improved
+inline void minPlusRowNext(float* c, int* next, const float* b, float a, int hop, int len)
+{
+    int j = 0;
+#if defined(__AVX__)
+    __m256 va = _mm256_set1_ps(a);
+    __m256 vhop = _mm256_castsi256_ps(_mm256_set1_epi32(hop));
+    for (; j + 8 <= len; j += 8) {
+        __m256 cand = _mm256_add_ps(va, _mm256_loadu_ps(b + j));
+        __m256 cur = _mm256_loadu_ps(c + j);
+        __m256 better = _mm256_cmp_ps(cand, cur, _CMP_LT_OQ);
+        __m256 hops = _mm256_loadu_ps(reinterpret_cast<const float*>(next + j));
+        _mm256_storeu_ps(c + j, _mm256_blendv_ps(cur, cand, better));
+        _mm256_storeu_ps(reinterpret_cast<float*>(next + j), _mm256_blendv_ps(hops, vhop, better));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 va = _mm_set1_ps(a);
+    __m128i vhop = _mm_set1_epi32(hop);
+    for (; j + 4 <= len; j += 4) {
+        __m128 cand = _mm_add_ps(va, _mm_loadu_ps(b + j));
+        __m128 cur = _mm_loadu_ps(c + j);
+        __m128i better = _mm_castps_si128(_mm_cmplt_ps(cand, cur));
+        __m128i hops = _mm_loadu_si128(reinterpret_cast<const __m128i*>(next + j));
+        _mm_storeu_ps(c + j, _mm_min_ps(cur, cand));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(next + j),
+                         _mm_or_si128(_mm_and_si128(better, vhop), _mm_andnot_si128(better, hops)));
+    }
+#endif
+    for (; j < len; ++j) {
+        float cand = a + b[j];
+        if (cand < c[j]) {
+            c[j] = cand;
+            next[j] = hop;
+        }
+    }
+}
+
+// Relaxes tile (bi, bj) through the k range of tile bk
+void relaxTile(float* dist, int* next, int n, int stride, int bi, int bj, int bk)
+{
+    int i0 = bi * TILE, i1 = min(n, i0 + TILE);
+    int j0 = bj * TILE, j1 = min(n, j0 + TILE);
+    int k0 = bk * TILE, k1 = min(n, k0 + TILE);
+
+    for (int k = k0; k < k1; ++k) {
+        const float* rowK = dist + (size_t)k * stride + j0;
+        for (int i = i0; i < i1; ++i) {
+            float* rowI = dist + (size_t)i * stride;
+            float a = rowI[k];
+            if (a >= GraphCore::INF) continue;
+            if (next) {
+                int* nextI = next + (size_t)i * stride;
+                minPlusRowNext(rowI + j0, nextI + j0, rowK, a, nextI[k], j1 - j0);
+            } else {
+                minPlusRow(rowI + j0, rowK, a, j1 - j0);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void DistanceMatrix::reset(int size, float fill)
+{
+    n = size;
+    data.assign((size_t)n * n, fill);
+    METRIC_ADD(BufferAllocations, 1);
+}
+
+bool floydWarshallBlocked(float* dist, int* next, int n, int stride, ThreadPool* pool, JobControl* job)
+{
+    int tiles = (n + TILE - 1) / TILE;
+    auto forEach = [&](int count, const function<void(int)>& body) {
+        if (pool) pool->parallelFor(count, body);
+        else for (int i = 0; i < count; ++i) body(i);
+    };
+
+    for (int bk = 0; bk < tiles; ++bk) {
+        if (job) {
+            if (job->isCancelled()) return false;
+            job->progress(bk, tiles);
+        }
+
+        // Phase 1: the diagonal tile depends only on itself
+        relaxTile(dist, next, n, stride, bk, bk, bk);
+
+        // Phase 2: tiles in row bk and column bk depend on the diagonal tile
+        forEach(2 * tiles, [&](int t) {
+            int other = t % tiles;
+            if (other == bk) return;
+            if (t < tiles) relaxTile(dist, next, n, stride, bk, other, bk);
+            else relaxTile(dist, next, n, stride, other, bk, bk);
+        });
+
+        // Phase 3: every remaining tile depends on its row and column tiles; one task per tile row
+        forEach(tiles, [&](int bi) {
+            if (bi == bk) return;
+            for (int bj = 0; bj < tiles; ++bj) {
+                if (bj != bk) relaxTile(dist, next, n, stride, bi, bj, bk);
+            }
+        });
+    }
+    METRIC_ADD(DpCells, (uint64_t)n * n * n);
+    return true;
+}
+
+bool allPairsShortestPaths(const GraphCore& graph, DistanceMatrix& dist, const vector<int>& order,
+                           ThreadPool* pool, JobControl* job)
+{
+    int n = graph.cityCount();
+    vector<int> slot(n);
+    for (int i = 0; i < n; ++i) slot[order.empty() ? i : order[i]] = i;
+
+    dist.reset(n);
+    for (int i = 0; i < n; ++i) dist.at(i, i) = 0;
+
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<float>& weights = graph.weights();
+    for (int u = 0; u < n; ++u) {
+        float* row = dist.row(slot[u]);
+        for (int k = offsets[u]; k < offsets[u + 1]; ++k) row[slot[targets[k]]] = weights[k];
+    }
+
+    return floydWarshallBlocked(dist.row(0), nullptr, n, n, pool, job);
+}
+
+void PathCache::invalidate()
+{
+    valid = false;
+    n = stride = 0;
+    dist.clear();
+    next.clear();
+}
+
+void PathCache::grow(int cities)
+{
+    if (cities <= n) return;
+
+    if (cities > stride) {
+        int newStride = max(cities, stride * 2);
+        vector<float> newDist((size_t)newStride * newStride, GraphCore::INF);
+        vector<int> newNext((size_t)newStride * newStride, -1);
+        for (int i = 0; i < n; ++i) {
+            copy_n(dist.begin() + (size_t)i * stride, n, newDist.begin() + (size_t)i * newStride);
+            copy_n(next.begin() + (size_t)i * stride, n, newNext.begin() + (size_t)i * newStride);
+        }
+        dist.swap(newDist);
+        next.swap(newNext);
+        stride = newStride;
+        METRIC_ADD(BufferAllocations, 2);
+    }
+
+    // New cities start isolated
+    for (int i = n; i < cities; ++i) {
+        dist[(size_t)i * stride + i] = 0;
+        next[(size_t)i * stride + i] = i;
+    }
+    n = cities;
+}
+
+bool PathCache::rebuild(const GraphCore& graph, ThreadPool* pool, JobControl* job)
+{
+    invalidate();
+    if (graph.cityCount() > MAX_CITIES) return false;
+
+    grow(graph.cityCount());
+    const vector<int>& offsets = graph.offsets();
+    const vector<int>& targets = graph.targets();
+    const vector<float>& weights = graph.weights();
+    for (int u = 0; u < n; ++u) {
+        for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+            dist[(size_t)u * stride + targets[k]] = weights[k];
+            next[(size_t)u * stride + targets[k]] = targets[k];
+        }
+    }
+
+    if (n > 0 && !floydWarshallBlocked(dist.data(), next.data(), n, stride, pool, job)) {
+        invalidate();
+        return false;
+    }
+    valid = true;
+    return true;
+}
+
+void PathCache::edgeChanged(const GraphCore& graph, int from, int to, float distance, float previous)
+{
+    if (!valid) return;
+    if (graph.cityCount() > MAX_CITIES || distance > previous || from == to) {
+        // Lengthened edges and self-loops can't be repaired by relaxation alone
+        invalidate();
+        return;
+    }
+    grow(graph.cityCount());
+    if (distance == previous) return;
+
+    // d[i][j] = min(d[i][j], d[i][from] + distance + d[to][j]). With non-negative weights
+    // column `from` and row `to` are fixed points of this update, so one pass suffices.
+    const float* rowTo = &dist[(size_t)to * stride];
+    for (int i = 0; i < n; ++i) {
+        float a = (i == from) ? 0 : dist[(size_t)i * stride + from];   // The diagonal may hold a self-loop
+        if (a >= GraphCore::INF) continue;
+        int hop = (i == from) ? to : next[(size_t)i * stride + from];
+        float* rowI = &dist[(size_t)i * stride];
+        minPlusRowNext(rowI, &next[(size_t)i * stride], rowTo, a + distance, hop, n);
+
+        // Likewise rowTo[to] may hold a self-loop, so the path ending at `to` is checked on its own
+        if (a + distance < rowI[to]) {
+            rowI[to] = a + distance;
+            next[(size_t)i * stride + to] = hop;
+        }
+    }
+}
+
+float PathCache::distance(int from, int to) const
+{
+    return dist[(size_t)from * stride + to];
+}
+
+bool PathCache::path(int from, int to, vector<int>& out) const
+{
+    out.clear();
+    if (distance(from, to) >= GraphCore::INF) return false;
+
+    out.push_back(from);
+    for (int at = from; at != to; ) {
+        at = next[(size_t)at * stride + to];
+        out.push_back(at);
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef ALLPAIRS_H
+#define ALLPAIRS_H
+
+#include <vector>
+#include "graphcore.h"
+#include "threadpool.h"
+using namespace std;
+
+class JobControl;
+
+// Square distance matrix stored in one contiguous row-major block
+class DistanceMatrix {
+public:
+    DistanceMatrix() = default;
+    explicit DistanceMatrix(int n, float fill = GraphCore::INF) { reset(n, fill); }
+
+    void reset(int n, float fill = GraphCore::INF);
+    int size() const { return n; }
+
+    float* row(int i) { return data.data() + (size_t)i * n; }
+    const float* row(int i) const { return data.data() + (size_t)i * n; }
+    float& at(int i, int j) { return data[(size_t)i * n + j]; }
+    float at(int i, int j) const { return data[(size_t)i * n + j]; }
+
+private:
+    int n = 0;
+    vector<float> data;
+};
+
+// Cache-blocked Floyd-Warshall over an n x n row-major matrix with the given row stride.
+// If next is given (same layout) it is kept as a next-hop matrix: next[i][j] = next[i][k] on improvement.
+// Tiles that are independent within a phase run on the pool; pass nullptr to stay single-threaded.
+// Returns false, leaving the matrix half-relaxed, if job is cancelled between phases.
+bool floydWarshallBlocked(float* dist, int* next, int n, int stride, ThreadPool* pool, JobControl* job = nullptr);
+
+// Fills dist with the edge weights of graph (0 on the diagonal) and runs the blocked solver.
+// order[i] is the city id placed at row/column i; an empty order means identity.
+bool allPairsShortestPaths(const GraphCore& graph, DistanceMatrix& dist, const vector<int>& order = {},
+                           ThreadPool* pool = &ThreadPool::shared(), JobControl* job = nullptr);
+
+// All-pairs distances and next hops indexed by city id, kept valid across edits.
+// Inserted or shortened edges are repaired in O(V^2); anything else falls back to a rebuild.
+class PathCache {
+public:
+    static const int MAX_CITIES = 8192;     // Beyond this the matrices are not worth keeping
+
+    bool isValid() const { return valid; }
+    int size() const { return n; }
+    void invalidate();
+
+    // Full recompute; returns false (and stays invalid) if the graph is too large or job is cancelled
+    bool rebuild(const GraphCore& graph, ThreadPool* pool = &ThreadPool::shared(), JobControl* job = nullptr);
+
+    // Call after graph.addEdge(from, to, distance) replaced an edge of weight previous (INF if new)
+    void edgeChanged(const GraphCore& graph, int from, int to, float distance, float previous);
+
+    float distance(int from, int to) const;
+    bool path(int from, int to, vector<int>& out) const;   // false when unreachable
+
+private:
+    bool valid = false;
+    int n = 0;
+    int stride = 0;
+    vector<float> dist;
+    vector<int> next;   // next[i][j] = city after i on a shortest i -> j path, -1 if none
+
+    void grow(int cities);
+};
+
+#endif // ALLPAIRS_H
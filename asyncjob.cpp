@@ -0,0 +1,16 @@
+#include "asyncjob.h"
+#include <algorithm>
+
+void JobControl::progress(double done, double total)
+{
+    int now = total > 0 ? (int)(min(done / total, 1.0) * 100) : 100;
+    int seen = lastPercent.load(memory_order_relaxed);
+
+    // Parallel loops report out of order; only the thread that raises the mark passes it on
+    while (now > seen) {
+        if (lastPercent.compare_exchange_weak(seen, now, memory_order_relaxed)) {
+            if (onProgress) onProgress(now);
+            return;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef ASYNCJOB_H
+#define ASYNCJOB_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include "threadpool.h"
+using namespace std;
+
+// Cancellation and progress for one long-running query. Algorithms take an optional
+// JobControl* and poll it between units of work; nullptr runs them to completion silently.
+// Every member may be used from any thread.
+class JobControl {
+public:
+    void cancel() { cancelled.store(true, memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(memory_order_relaxed); }
+
+    // Reports done / total; the listener only hears about whole-percent increases
+    void progress(double done, double total);
+    int percent() const { return lastPercent.load(memory_order_relaxed); }
+
+    function<void(int percent)> onProgress;    // Set before the job starts; runs on the reporting thread
+
+private:
+    atomic<bool> cancelled{false};
+    atomic<int> lastPercent{0};
+};
+
+// Handle to a query started with startJob. Copies share the job; the job runs to the end
+// (or to its next cancellation check) even if every handle is dropped.
+template <typename T>
+class Job {
+public:
+    Job() = default;
+    Job(shared_ptr<JobControl> control, shared_future<T> result, shared_future<void> finished)
+        : control(move(control)), result(move(result)), finished(move(finished)) {}
+
+    bool isValid() const { return control != nullptr; }
+    bool isDone() const { return finished.wait_for(chrono::seconds(0)) == future_status::ready; }
+    void cancel() const { if (control) control->cancel(); }
+    bool isCancelled() const { return control && control->isCancelled(); }
+    int percent() const { return control ? control->percent() : 0; }
+
+    void wait() const { if (isValid()) finished.wait(); }    // Until the completion callback has returned too
+    const T& get() const { return result.get(); }           // Waits for the result; rethrows what the work threw
+
+    JobControl* controller() const { return control.get(); }
+
+private:
+    shared_ptr<JobControl> control;
+    shared_future<T> result;
+    shared_future<void> finished;
+};
+
+// Runs work(control) on the pool. onProgress gets whole percentages as the work reports them and
+// onDone(job) runs once the result is ready; both run on a worker thread, so GUI code forwards
+// them through queued signals. A cancelled job still finishes, with whatever partial result the
+// work returned, and isCancelled() tells the two apart.
+template <typename T, typename Work, typename Done>
+Job<T> startJob(Work work, Done onDone, function<void(int)> onProgress = nullptr,
+                ThreadPool* pool = &ThreadPool::shared())
+{
+    auto control = make_shared<JobControl>();
+    control->onProgress = move(onProgress);
+    auto promise = make_shared<std::promise<T>>();
+    auto finished = make_shared<std::promise<void>>();
+    Job<T> job(control, promise->get_future().share(), finished->get_future().share());
+
+    pool->submit([job, promise, finished, work = move(work), onDone = move(onDone)]() mutable {
+        try {
+            promise->set_value(work(*job.controller()));
+        } catch (...) {
+            promise->set_exception(current_exception());
+        }
+        onDone(job);
+        finished->set_value();
+    });
+    return job;
+}
+
+// Same without a completion callback, for callers that wait on the handle
+template <typename T, typename Work>
+Job<T> startJob(Work work, ThreadPool* pool = &ThreadPool::shared())
+{
+    return startJob<T>(move(work), [](const Job<T>&) {}, nullptr, pool);
+}
+
+#endif // ASYNCJOB_H
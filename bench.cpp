@@ -0,0 +1,598 @@
+// Benchmark suite for the core library.
+// Generates synthetic hotel sets and city graphs from a fixed seed, times every hotel and graph
+// operation and writes a JSON report (timings in nanoseconds per iteration, heap allocations per
+// iteration and throughput in items per second) so runs can be compared between releases.
+//
+//   smarttravel-bench [--suite quick|full] [--hotels N,...] [--cities N,...] [--repeat N]
+//                     [--seed S] [--filter TEXT] [--out FILE] [--data-dir DIR]
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+#include <cstdlib>
+#include <new>
+#include "management.h"
+using namespace std;
+
+// Every heap allocation made by the process goes through these, so the report can count them.
+// GCC cannot see that the replaced new and delete pair up and warns wherever both get inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static atomic<uint64_t> allocationCount{0};
+static atomic<uint64_t> allocatedBytes{0};
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    allocatedBytes.fetch_add(size, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct BenchResult {
+    string name;
+    vector<pair<string, long long>> params;
+    double items = 0;                   // Work items per iteration (rows, queries, edges...)
+    vector<double> nanoseconds;         // One entry per timed iteration
+    double allocations = 0;             // Per iteration
+    double bytes = 0;
+};
+
+class BenchRunner {
+public:
+    BenchRunner(int repeat, const string& filter) : repeat(repeat), filter(filter) {}
+
+    bool wants(const string& name) const { return filter.empty() || name.find(filter) != string::npos; }
+
+    // Times body repeat times; setup runs untimed (and uncounted) before each iteration.
+    // With warmup the body runs once first so lazily built structures are not charged to it.
+    void run(const string& name, const vector<pair<string, long long>>& params, double items,
+             const function<void()>& body, const function<void()>& setup = nullptr, bool warmup = false);
+
+    const vector<BenchResult>& results() const { return done; }
+
+private:
+    int repeat;
+    string filter;
+    vector<BenchResult> done;
+};
+
+void BenchRunner::run(const string& name, const vector<pair<string, long long>>& params, double items,
+                      const function<void()>& body, const function<void()>& setup, bool warmup)
+{
+    if (!wants(name)) return;
+
+    cerr << name;
+    for (const auto& [key, value] : params) cerr << ' ' << key << '=' << value;
+    cerr << " ..." << flush;
+
+    if (warmup) {
+        if (setup) setup();
+        body();
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+    result.items = items;
+    uint64_t allocations = 0, bytes = 0;
+    for (int i = 0; i < repeat; ++i) {
+        if (setup) setup();
+        uint64_t allocationsBefore = allocationCount.load(), bytesBefore = allocatedBytes.load();
+        auto start = chrono::steady_clock::now();
+        body();
+        auto stop = chrono::steady_clock::now();
+        allocations += allocationCount.load() - allocationsBefore;
+        bytes += allocatedBytes.load() - bytesBefore;
+        result.nanoseconds.push_back(chrono::duration<double, nano>(stop - start).count());
+    }
+    result.allocations = (double)allocations / repeat;
+    result.bytes = (double)bytes / repeat;
+
+    vector<double> sorted = result.nanoseconds;
+    sort(sorted.begin(), sorted.end());
+    cerr << ' ' << sorted[sorted.size() / 2] / 1e6 << " ms" << endl;
+    done.push_back(move(result));
+}
+
+// Synthetic data, fully determined by the seed
+
+static const char* SYLLABLES[] = {"al", "be", "ca", "do", "el", "fa", "gi", "ho",
+                                  "in", "ju", "ka", "lo", "ma", "no", "or", "pa"};
+
+static string randomName(mt19937_64& random)
+{
+    string name;
+    int syllables = 2 + random() % 4;
+    for (int i = 0; i < syllables; ++i) name += SYLLABLES[random() % 16];
+    name[0] = toupper(name[0]);
+    return name;
+}
+
+static string cityName(int id) { return "city" + to_string(id); }
+
+// Hotels cluster around HOTEL_CITIES city centres scattered over the globe
+static const int HOTEL_CITIES = 500;
+
+static void cityCentre(int city, uint64_t seed, float& latitude, float& longitude)
+{
+    mt19937_64 random(seed ^ (0x9e3779b97f4a7c15ull * (city + 1)));
+    latitude = uniform_real_distribution<float>(-60.0f, 70.0f)(random);
+    longitude = uniform_real_distribution<float>(-180.0f, 180.0f)(random);
+}
+
+static void generateHotels(size_t count, uint64_t seed, HotelColumns& columns)
+{
+    mt19937_64 random(seed);
+    uniform_real_distribution<float> offset(-0.3f, 0.3f);
+    columns.clear();
+    for (size_t i = 0; i < count; ++i) {
+        int price = 30 + random() % 971;
+        float rating = (10 + random() % 41) / 10.0f;
+        float distance = (1 + random() % 300) / 10.0f;
+        string name = randomName(random);
+        int city = random() % HOTEL_CITIES;
+        string cityText = cityName(city);
+        HotelLocation location;
+        cityCentre(city, seed, location.latitude, location.longitude);
+        location.latitude += offset(random);
+        location.longitude += offset(random);
+        location.city = cityText;
+        columns.append(i + 1, name, price, rating, distance, location);
+    }
+}
+
+static bool writeLegacyHotels(const string& path, const HotelColumns& columns)
+{
+    ofstream out(path, ios::trunc);
+    out.precision(9);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        HotelLocation location = columns.location(i);
+        out << columns.ids[i] << ' ' << columns.name(i) << ' ' << columns.prices[i] << ' '
+            << columns.ratings[i] << ' ' << columns.distances[i] << ' '
+            << location.latitude << ' ' << location.longitude << ' ' << location.city << '\n';
+    }
+    return (bool)out;
+}
+
+struct Road {
+    int from, to;
+    float distance;
+};
+
+// Connected undirected graph: a random spanning tree plus random extra roads up to the average degree
+static vector<Road> generateRoads(int cities, int degree, uint64_t seed)
+{
+    mt19937_64 random(seed);
+    uniform_real_distribution<float> length(1.0f, 100.0f);
+    vector<Road> roads;
+    for (int i = 1; i < cities; ++i) roads.push_back({i, (int)(random() % i), length(random)});
+    size_t total = max<size_t>(roads.size(), (size_t)cities * degree / 2);
+    while (roads.size() < total) {
+        int a = random() % cities, b = random() % cities;
+        if (a != b) roads.push_back({a, b, length(random)});
+    }
+    return roads;
+}
+
+// Benchmarks
+
+struct Options {
+    vector<long long> hotelCounts;
+    vector<long long> cityCounts;
+    int maxFloydCities = 0;             // All-pairs runs are O(V^3), only the smaller graphs get them
+    long long maxKnapsackHotels = 0;
+    int repeat = 5;
+    uint64_t seed = 42;
+    string filter;
+    string outPath;
+    string dataDir;
+    string suite = "quick";
+};
+
+static void benchHotels(BenchRunner& runner, const Options& options, long long count)
+{
+    vector<pair<string, long long>> params = {{"hotels", count}};
+    HotelColumns columns;
+    generateHotels(count, options.seed, columns);
+
+    string dir = options.dataDir + "/hotels-" + to_string(count);
+    filesystem::create_directories(dir);
+    string textPath = dir + "/information.txt", binaryPath = dir + "/information.bin";
+    writeLegacyHotels(textPath, columns);
+
+    // Cold start: information.txt has to be parsed and converted
+    runner.run("hotels.read_text", params, count,
+               [&] { HotelManager manager(dir); },
+               [&] { filesystem::remove(binaryPath); });
+
+    // Warm start: information.bin is current and mapped directly
+    runner.run("hotels.read_binary", params, count, [&] { HotelManager manager(dir); });
+
+    HotelManager manager(dir);
+    const HotelTable& hotels = manager.getHotels();
+
+    runner.run("hotels.sort_price", params, count, [&] {
+        SortedIndex index(SortedIndex::Price);
+        index.rebuild(hotels);
+    });
+    runner.run("hotels.sort_rating", params, count, [&] {
+        SortedIndex index(SortedIndex::Rating);
+        index.rebuild(hotels);
+    });
+    runner.run("hotels.topk", params, count, [&] {
+        manager.topK({{SortKey::Rating, true}, {SortKey::Price, false}}, 100);
+    });
+
+    // Pareto front over the price index, and from scratch with a sort per run
+    vector<pair<string, long long>> skylineParams = params;
+    skylineParams.push_back({"front", (long long)manager.skyline().size()});
+    vector<uint32_t> front;
+    runner.run("hotels.skyline", skylineParams, count, [&] { front = manager.skyline(); });
+    runner.run("hotels.skyline_unindexed", skylineParams, count, [&] { skyline(hotels, HotelFilter(), front); });
+
+    HotelFilter filter;
+    filter.maxPrice = 300;
+    filter.minRating = 4.0f;
+    vector<uint64_t> bitmap;
+    runner.run("hotels.filter", params, count, [&] { filterHotels(hotels, filter, bitmap); });
+
+    // Name queries: a fixed sample of existing names, lightly misspelt for the fuzzy search
+    const int queries = 1000;
+    mt19937_64 random(options.seed + 1);
+    vector<string> names, typos;
+    for (int i = 0; i < queries; ++i) {
+        string name(hotels.name(random() % hotels.size()));
+        names.push_back(name);
+        name[random() % name.size()] = 'x';
+        typos.push_back(name);
+    }
+    const NameIndex& nameIndex = manager.getNameIndex();
+    vector<uint32_t> nameIds;
+
+    runner.run("hotels.search_exact", params, queries, [&] {
+        for (const string& name : names) manager.findByName(name);
+    });
+    runner.run("hotels.search_prefix", params, queries, [&] {
+        for (const string& name : names) nameIndex.prefix(hotels, string_view(name).substr(0, 3));
+    });
+    runner.run("hotels.search_substring", params, queries, [&] {
+        for (const string& name : names) nameIndex.substring(hotels, string_view(name).substr(1, 3), nameIds, 20);
+    }, nullptr, true);
+    runner.run("hotels.search_fuzzy", params, queries / 10, [&] {
+        for (int i = 0; i < queries / 10; ++i) nameIndex.fuzzy(hotels, typos[i], 1, nameIds, 20);
+    }, nullptr, true);
+
+    // Location queries around a fixed sample of hotels
+    vector<pair<float, float>> points;
+    for (int i = 0; i < queries; ++i) {
+        uint32_t row = random() % hotels.size();
+        points.push_back({hotels.latitude(row), hotels.longitude(row)});
+    }
+    runner.run("hotels.nearest", params, queries, [&] {
+        for (auto [latitude, longitude] : points) manager.nearest(latitude, longitude, 10);
+    });
+    runner.run("hotels.within", params, queries, [&] {
+        for (auto [latitude, longitude] : points) manager.within(latitude, longitude, 5.0f, filter);
+    });
+
+    if (count <= options.maxKnapsackHotels) {
+        const int budget = 1000;
+        Recommender recommender;
+        runner.run("hotels.knapsack", {{"hotels", count}, {"budget", budget}}, (double)count * budget,
+                   [&] { recommender.bestCombination(hotels, budget, 4.0f); });
+    }
+
+    // Appends go through the log, so they run against a copy of the data directory. The writer is
+    // opened in setup, keeping the load (and the previous writer's checkpoint) out of the timing.
+    const int adds = 1000;
+    string addDir = dir + "-add";
+    unique_ptr<HotelManager> writer;
+    auto openCopy = [&] {
+        writer.reset();
+        filesystem::remove_all(addDir);
+        filesystem::create_directories(addDir);
+        filesystem::copy_file(textPath, addDir + "/information.txt");
+        filesystem::copy_file(binaryPath, addDir + "/information.bin");
+        writer = make_unique<HotelManager>(addDir);
+    };
+    vector<Hotel> batch;
+    for (int i = 0; i < adds; ++i) batch.emplace_back(0, "Benchhotel", 100 + i, 4.0f, 1.0f);
+
+    runner.run("hotels.add", params, adds, [&] {
+        for (const Hotel& h : batch) writer->addHotel(h.getName(), h.getPrice(), h.getRating(), h.getDistance());
+    }, openCopy);
+    runner.run("hotels.add_batch", params, adds, [&] { writer->addHotels(batch); }, openCopy);
+    writer.reset();
+
+    filesystem::remove_all(addDir);
+    filesystem::remove_all(dir);
+}
+
+static void benchGraph(BenchRunner& runner, const Options& options, int cities, bool dense)
+{
+    int degree = dense ? min(cities / 2, 64) : 4;
+    vector<Road> roads = generateRoads(cities, degree, options.seed + cities);
+    vector<pair<string, long long>> params = {{"cities", cities}, {"roads", (long long)roads.size()}};
+    string kind = dense ? "dense" : "sparse";
+
+    vector<string> names(cities);
+    for (int i = 0; i < cities; ++i) names[i] = cityName(i);
+
+    Graph graph;
+    runner.run("graph." + kind + ".build", params, roads.size(), [&] {
+        graph = Graph();
+        for (const Road& road : roads) graph.addPath(names[road.from], names[road.to], road.distance);
+    });
+    if (graph.empty()) {
+        for (const Road& road : roads) graph.addPath(names[road.from], names[road.to], road.distance);
+    }
+
+    // The same roads through the bulk loader, and the graph through a binary snapshot
+    string edgeListPath = options.dataDir + "/roads-" + kind + "-" + to_string(cities) + ".csv";
+    string snapshotPath = options.dataDir + "/graph-" + kind + "-" + to_string(cities) + ".bin";
+    {
+        ofstream out(edgeListPath, ios::binary);
+        out << "from,to,km\n";
+        for (const Road& road : roads) out << names[road.from] << ',' << names[road.to] << ',' << road.distance << '\n';
+    }
+    runner.run("graph." + kind + ".import", params, roads.size(), [&] {
+        Graph imported;
+        string error;
+        imported.importRoads(edgeListPath, error);
+    });
+    runner.run("graph." + kind + ".snapshot_save", params, roads.size(), [&] { graph.save(snapshotPath); });
+    runner.run("graph." + kind + ".snapshot_load", params, roads.size(), [&] {
+        Graph loaded;
+        loaded.load(snapshotPath);
+    });
+    filesystem::remove(edgeListPath);
+    filesystem::remove(snapshotPath);
+
+    const int queries = 32;
+    mt19937_64 random(options.seed + 2);
+    vector<pair<int, int>> pairs;
+    for (int i = 0; i < queries; ++i) pairs.push_back({(int)(random() % cities), (int)(random() % cities)});
+
+    graph.cache.invalidate();
+    runner.run("graph." + kind + ".dijkstra", params, queries, [&] {
+        for (const auto& [s, t] : pairs) graph.dijkstra(names[s], names[t]);
+    });
+
+    // Point-to-point searches on ids, each reporting the average number of cities it settled
+    runner.run("graph." + kind + ".landmarks", params, cities, [&] { graph.core.buildLandmarks(); });
+    const pair<const char*, RouteAlgorithm> algorithms[] = {{"route_dijkstra", RouteAlgorithm::Dijkstra},
+                                                            {"route_bidirectional", RouteAlgorithm::Bidirectional},
+                                                            {"route_alt", RouteAlgorithm::Landmarks}};
+    for (const auto& [name, algorithm] : algorithms) {
+        long long settled = 0;
+        for (const auto& [s, t] : pairs) {
+            int count;
+            graph.core.route(s, t, algorithm, nullptr, &count);
+            settled += count;
+        }
+        vector<pair<string, long long>> routeParams = params;
+        routeParams.push_back({"settled", settled / queries});
+        vector<int> path;
+        runner.run("graph." + kind + "." + name, routeParams, queries, [&] {
+            for (const auto& [s, t] : pairs) graph.core.route(s, t, algorithm, &path);
+        });
+    }
+
+    // Random dense graphs contract into large cliques; hierarchies are for road-like graphs
+    ContractionHierarchy& hierarchy = graph.hierarchy;
+    if (!dense) runner.run("graph." + kind + ".hierarchy_build", params, cities, [&] { hierarchy.build(graph.core); });
+    if (hierarchy.isCurrent(graph.core)) {
+        long long settled = 0;
+        for (const auto& [s, t] : pairs) {
+            int count;
+            hierarchy.route(s, t, nullptr, &count);
+            settled += count;
+        }
+        vector<pair<string, long long>> routeParams = params;
+        routeParams.push_back({"settled", settled / queries});
+        routeParams.push_back({"shortcuts", (long long)hierarchy.shortcutCount()});
+        vector<int> path;
+        runner.run("graph." + kind + ".route_hierarchy", routeParams, queries, [&] {
+            for (const auto& [s, t] : pairs) hierarchy.route(s, t, &path);
+        });
+    }
+
+    // Every source to the same set of targets, searched in parallel
+    const int targetCount = min(cities, 64);
+    vector<RouteQuery> batch(queries);
+    for (int i = 0; i < queries; ++i) {
+        batch[i].source = random() % cities;
+        for (int j = 0; j < targetCount; ++j) batch[i].targets.push_back(random() % cities);
+    }
+    RouteMatrix routes;
+    runner.run("graph." + kind + ".route_batch", params, (double)queries * targetCount,
+               [&] { routeBatch(graph.core, batch, routes); });
+
+    if (cities > options.maxFloydCities) return;
+
+    runner.run("graph." + kind + ".floyd_warshall", params, (double)cities * cities * cities,
+               [&] { graph.floydWarshall(); },
+               [&] { graph.cache.invalidate(); });
+    if (!graph.cache.isValid()) graph.cache.rebuild(graph.core);
+
+    runner.run("graph." + kind + ".dijkstra_cached", params, queries, [&] {
+        for (const auto& [s, t] : pairs) graph.dijkstra(names[s], names[t]);
+    });
+
+    // Tours over cached distances: Held-Karp at the exact limit, local search on its time budget beyond it
+    ItineraryOptions tourOptions;
+    tourOptions.returnToStart = true;
+    tourOptions.budget = chrono::milliseconds(50);
+    for (int stopCount : {tourOptions.exactLimit, 100}) {
+        // Spread over the whole id range, never the start
+        int count = min(stopCount, cities - 1);
+        vector<string> stops;
+        for (int i = 1; i <= count; ++i) stops.push_back(names[(long long)i * (cities - 1) / count]);
+        vector<pair<string, long long>> tourParams = params;
+        tourParams.push_back({"stops", (long long)stops.size()});
+        Itinerary itinerary;
+        string error;
+        runner.run("graph." + kind + (stopCount > tourOptions.exactLimit ? ".itinerary_search" : ".itinerary_exact"),
+                   tourParams, 1, [&] { graph.planItinerary(names[0], stops, tourOptions, itinerary, error); });
+    }
+
+    // Shortened roads keep the all-pairs cache valid and are repaired in O(V^2) each
+    runner.run("graph." + kind + ".add_path_incremental", params, queries, [&] {
+        for (const auto& [s, t] : pairs) {
+            if (s != t) graph.addPath(names[s], names[t], 0.5f);
+        }
+    });
+}
+
+// JSON report
+
+static string jsonString(const string& text)
+{
+    string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeReport(ostream& out, const Options& options, const vector<BenchResult>& results)
+{
+    out << "{\n";
+    out << "  \"suite\": " << jsonString(options.suite) << ",\n";
+    out << "  \"seed\": " << options.seed << ",\n";
+    out << "  \"repeat\": " << options.repeat << ",\n";
+    out << "  \"threads\": " << ThreadPool::shared().size() << ",\n";
+#ifdef __VERSION__
+    out << "  \"compiler\": " << jsonString(__VERSION__) << ",\n";
+#endif
+#ifdef NDEBUG
+    out << "  \"optimized\": true,\n";
+#else
+    out << "  \"optimized\": false,\n";
+#endif
+    out << "  \"results\": [";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const BenchResult& result = results[r];
+        vector<double> sorted = result.nanoseconds;
+        sort(sorted.begin(), sorted.end());
+        double mean = 0;
+        for (double ns : sorted) mean += ns;
+        mean /= sorted.size();
+        double median = sorted[sorted.size() / 2];
+
+        out << (r ? ",\n" : "\n") << "    {\"name\": " << jsonString(result.name) << ", \"params\": {";
+        for (size_t p = 0; p < result.params.size(); ++p) {
+            out << (p ? ", " : "") << jsonString(result.params[p].first) << ": " << result.params[p].second;
+        }
+        out << "}, \"iterations\": " << sorted.size()
+            << ", \"ns\": {\"min\": " << sorted.front() << ", \"median\": " << median
+            << ", \"mean\": " << mean << ", \"max\": " << sorted.back() << "}"
+            << ", \"items\": " << result.items
+            << ", \"items_per_second\": " << (median > 0 ? result.items * 1e9 / median : 0)
+            << ", \"allocations\": " << result.allocations
+            << ", \"allocated_bytes\": " << result.bytes << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static bool parseList(const string& text, vector<long long>& values)
+{
+    values.clear();
+    stringstream in(text);
+    for (string item; getline(in, item, ',');) {
+        char* end;
+        long long value = strtoll(item.c_str(), &end, 10);
+        if (item.empty() || *end || value <= 0) return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    string hotels, cities;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--suite" && hasValue) options.suite = argv[++i];
+        else if (arg == "--hotels" && hasValue) hotels = argv[++i];
+        else if (arg == "--cities" && hasValue) cities = argv[++i];
+        else if (arg == "--repeat" && hasValue) options.repeat = max(1, atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) options.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+        else if (arg == "--data-dir" && hasValue) options.dataDir = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [--suite quick|full] [--hotels N,...] [--cities N,...] [--repeat N]\n"
+                 << "       [--seed S] [--filter TEXT] [--out FILE] [--data-dir DIR]" << endl;
+            return 2;
+        }
+    }
+
+    if (options.suite == "quick") {
+        options.hotelCounts = {1000, 100000};
+        options.cityCounts = {100, 1000};
+        options.maxFloydCities = 1000;
+        options.maxKnapsackHotels = 100000;
+    } else if (options.suite == "full") {
+        options.hotelCounts = {1000, 10000, 100000, 1000000, 10000000};
+        options.cityCounts = {100, 1000, 10000, 100000};
+        options.maxFloydCities = 2000;
+        options.maxKnapsackHotels = 1000000;
+    } else {
+        cerr << "Unknown suite: " << options.suite << endl;
+        return 2;
+    }
+    if ((!hotels.empty() && !parseList(hotels, options.hotelCounts)) ||
+        (!cities.empty() && !parseList(cities, options.cityCounts))) {
+        cerr << "Sizes must be comma-separated positive numbers" << endl;
+        return 2;
+    }
+
+    bool ownDataDir = options.dataDir.empty();
+    if (ownDataDir) {
+        options.dataDir = (filesystem::temp_directory_path() / ("smarttravel-bench-" + to_string(options.seed))).string();
+    }
+    filesystem::create_directories(options.dataDir);
+
+    // HotelManager logs every load and save; keep the report quiet
+    streambuf* logBuffer = clog.rdbuf(nullptr);
+
+    BenchRunner runner(options.repeat, options.filter);
+    for (long long count : options.hotelCounts) benchHotels(runner, options, count);
+    for (long long count : options.cityCounts) {
+        benchGraph(runner, options, count, false);
+        benchGraph(runner, options, count, true);
+    }
+
+    clog.clear();
+    clog.rdbuf(logBuffer);
+    if (ownDataDir) filesystem::remove_all(options.dataDir);
+
+    if (options.outPath.empty()) {
+        writeReport(cout, options, runner.results());
+    } else {
+        ofstream out(options.outPath);
+        writeReport(out, options, runner.results());
+        if (!out) {
+            cerr << "Unable to write " << options.outPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,13 @@
+# Benchmark suite with JSON reports, see bench.cpp for the options (build in release mode)
+QT -= core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = smarttravel-bench
+TEMPLATE = app
+
+include(core.pri)
+
+SOURCES += \
+    bench.cpp
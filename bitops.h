@@ -0,0 +1,33 @@
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit; word must not be zero
+inline int lowestBit(uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Index of the highest set bit; word must not be zero
+inline int highestBit(uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return index;
+#else
+    return 63 - __builtin_clzll(word);
+#endif
+}
+
+#endif // BITOPS_H
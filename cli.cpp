@@ -0,0 +1,508 @@
+// Headless batch driver for the core library.
+// Reads one command per line from a file or stdin and streams the results to stdout as
+// tab-separated lines, each command's output followed by an empty line. Diagnostics go to stderr.
+//
+//   smarttravel-cli [--data DIR] [--metrics FILE] [FILE]
+//
+// Run "help" for the command list.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <charconv>
+#include "management.h"
+using namespace std;
+
+static const char* USAGE =
+    "Commands (one per line, # starts a comment):\n"
+    "  list                                   all hotels in file order\n"
+    "  sort price|rating|distance [LIMIT]     hotels by one attribute\n"
+    "  top K KEY[:asc|:desc]... [FILTER]...   best K hotels under a compound ordering\n"
+    "                                         KEY is price, rating, distance or id;\n"
+    "                                         FILTER is e.g. price<=300 rating>=4 distance<=2\n"
+    "  skyline [FILTER]... [rank=WP,WR,WD]    hotels no other beats on price, rating and distance\n"
+    "                                         at once, cheapest first or best weighted score first\n"
+    "  search NAME                            hotels named exactly NAME\n"
+    "  prefix TEXT | substring TEXT           hotel names matching TEXT\n"
+    "  fuzzy EDITS TEXT                       hotel names within EDITS edits of TEXT\n"
+    "  knapsack BUDGET MIN_RATING             best-rated set of hotels within budget\n"
+    "  add-hotel NAME PRICE RATING DISTANCE [LAT LON [CITY]]\n"
+    "                                         adds a hotel with the next free ID\n"
+    "  get ID                                 the hotel with this ID (H12 or 12)\n"
+    "  update ID NAME PRICE RATING DISTANCE [LAT LON [CITY]]\n"
+    "                                         replaces a hotel's details\n"
+    "  remove ID                              removes a hotel\n"
+    "  near LAT LON K [FILTER]...             the K hotels nearest to a point, with km\n"
+    "  within LAT LON KM [FILTER]...          hotels within KM of a point\n"
+    "  by-road CITY KM [FILTER]...            hotels within KM of CITY by road (see path)\n"
+    "  reload                                 re-reads the hotel files\n"
+    "  export-text FILE                       writes the hotels as information.txt-style text\n"
+    "  path FROM TO KM                        adds a two-way road\n"
+    "  import-roads FILE                      adds the FROM,TO,KM roads of a CSV or TSV file\n"
+    "  save-graph FILE | load-graph FILE      writes or reads a binary snapshot of the roads\n"
+    "  route FROM TO [ALGORITHM]              shortest route; ALGORITHM is dijkstra (default),\n"
+    "                                         bidirectional, alt (A* with landmarks) or ch\n"
+    "                                         (the contraction hierarchy, see hierarchy)\n"
+    "  hierarchy [FILE]                       builds a contraction hierarchy for route, or loads\n"
+    "                                         it from FILE if built there for this exact graph\n"
+    "  routes FROM TO...                      distance and path to each TO, one line each\n"
+    "  itinerary START STOP... [round=yes] [budget=MS]\n"
+    "                                         shortest tour from START through every STOP, back\n"
+    "                                         to START with round=yes; exact up to 16 stops, else\n"
+    "                                         the best found by local search in MS (default 200)\n"
+    "  floyd                                  all-pairs distance table\n"
+    "  metrics                                latency percentiles and counters so far\n";
+
+template <typename T>
+static bool parseNumber(const string& text, T& value)
+{
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = from_chars(text.data(), end, value);
+    return ec == errc() && ptr == end;
+}
+
+// "H12" or "12"
+static bool parseHotelId(const string& text, int& id)
+{
+    return parseNumber(text.size() > 1 && (text[0] == 'H' || text[0] == 'h') ? text.substr(1) : text, id);
+}
+
+static string joinFrom(const vector<string>& words, size_t first)
+{
+    string text;
+    for (size_t i = first; i < words.size(); ++i) {
+        if (i > first) text += ' ';
+        text += words[i];
+    }
+    return text;
+}
+
+static void printHotel(const HotelTable& hotels, uint32_t row)
+{
+    cout << 'H' << hotels.id(row) << '\t' << hotels.name(row) << '\t' << hotels.price(row) << '\t'
+         << hotels.rating(row) << '\t' << hotels.distance(row);
+    HotelLocation location = hotels.location(row);
+    if (!location.empty()) cout << '\t' << location.latitude << '\t' << location.longitude << '\t' << location.city;
+    cout << '\n';
+}
+
+// Optional LAT LON [CITY] from words[first] on
+static bool parseLocation(const vector<string>& words, size_t first, HotelLocation& location)
+{
+    if (words.size() == first) return true;
+    if (words.size() < first + 2 || words.size() > first + 3) return false;
+    if (!parseNumber(words[first], location.latitude) || !parseNumber(words[first + 1], location.longitude)) return false;
+    if (words.size() == first + 3) location.city = words[first + 2];
+    return true;
+}
+
+static bool parseSortKey(const string& word, SortKey& key)
+{
+    size_t colon = word.find(':');
+    string name = word.substr(0, colon);
+    string direction = colon == string::npos ? "" : word.substr(colon + 1);
+
+    if (name == "price") key.attribute = SortKey::Price;
+    else if (name == "rating") key.attribute = SortKey::Rating;
+    else if (name == "distance") key.attribute = SortKey::Distance;
+    else if (name == "id") key.attribute = SortKey::Id;
+    else return false;
+
+    // Ratings read best-first unless asked otherwise
+    if (direction.empty()) key.descending = key.attribute == SortKey::Rating;
+    else if (direction == "asc") key.descending = false;
+    else if (direction == "desc") key.descending = true;
+    else return false;
+    return true;
+}
+
+// price<=N, rating>=R, distance<=D and so on; narrows filter
+static bool parseFilter(const string& word, HotelFilter& filter)
+{
+    size_t op = word.find_first_of("<>");
+    if (op == string::npos || op + 1 >= word.size() || word[op + 1] != '=') return false;
+
+    string name = word.substr(0, op), text = word.substr(op + 2);
+    bool upper = word[op] == '<';
+    if (name == "price") {
+        int value;
+        if (!parseNumber(text, value)) return false;
+        (upper ? filter.maxPrice : filter.minPrice) = value;
+    } else if (name == "rating" || name == "distance") {
+        float value;
+        if (!parseNumber(text, value)) return false;
+        if (name == "rating") (upper ? filter.maxRating : filter.minRating) = value;
+        else (upper ? filter.maxDistance : filter.minDistance) = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// "rank=1,2,0.5": weights for price, rating and distance
+static bool parseWeights(const string& word, SkylineWeights& weights)
+{
+    if (word.compare(0, 5, "rank=") != 0) return false;
+    size_t first = word.find(',', 5), second = first == string::npos ? first : word.find(',', first + 1);
+    if (second == string::npos) return false;
+    return parseNumber(word.substr(5, first - 5), weights.price)
+           && parseNumber(word.substr(first + 1, second - first - 1), weights.rating)
+           && parseNumber(word.substr(second + 1), weights.distance);
+}
+
+class BatchSession {
+public:
+    explicit BatchSession(const string& dataDir) : manager(dataDir) {}
+
+    // Runs one command line; returns false and fills error if it could not be run
+    bool run(const vector<string>& words, string& error);
+
+private:
+    HotelManager manager;
+    Recommender recommender;
+    Graph graph;
+
+    void printNames(const vector<uint32_t>& nameIds);
+    void printHits(const vector<GeoHit>& hits);
+};
+
+void BatchSession::printNames(const vector<uint32_t>& nameIds)
+{
+    const HotelTable& hotels = manager.getHotels();
+    for (uint32_t id : nameIds) {
+        for (uint32_t row : manager.getNameIndex().rowsOf(id)) printHotel(hotels, row);
+    }
+}
+
+void BatchSession::printHits(const vector<GeoHit>& hits)
+{
+    for (const GeoHit& hit : hits) {
+        cout << hit.km << "km\t";
+        printHotel(manager.getHotels(), hit.row);
+    }
+}
+
+bool BatchSession::run(const vector<string>& words, string& error)
+{
+    const string& command = words[0];
+    const HotelTable& hotels = manager.getHotels();
+
+    if (command == "help") {
+        cout << USAGE;
+    } else if (command == "list" && words.size() == 1) {
+        for (size_t row = 0; row < hotels.size(); ++row) {
+            if (hotels.isLive(row)) printHotel(hotels, row);
+        }
+    } else if (command == "sort" && (words.size() == 2 || words.size() == 3)) {
+        size_t limit = hotels.size();
+        if (words.size() == 3 && !parseNumber(words[2], limit)) {
+            error = "bad limit: " + words[2];
+            return false;
+        }
+        IndexSpan rows;
+        if (words[1] == "price") rows = manager.sortedByPrice();
+        else if (words[1] == "rating") rows = manager.sortedByRating();
+        else if (words[1] == "distance") rows = manager.sortedByDistance();
+        else {
+            error = "unknown sort key: " + words[1];
+            return false;
+        }
+        for (uint32_t row : rows) {
+            if (limit-- == 0) break;
+            printHotel(hotels, row);
+        }
+    } else if (command == "top" && words.size() >= 3) {
+        size_t k;
+        if (!parseNumber(words[1], k)) {
+            error = "bad count: " + words[1];
+            return false;
+        }
+        vector<SortKey> keys;
+        HotelFilter filter;
+        for (size_t i = 2; i < words.size(); ++i) {
+            SortKey key;
+            if (words[i].find_first_of("<>") != string::npos) {
+                if (!parseFilter(words[i], filter)) {
+                    error = "bad filter: " + words[i];
+                    return false;
+                }
+            } else if (parseSortKey(words[i], key)) {
+                keys.push_back(key);
+            } else {
+                error = "bad sort key: " + words[i];
+                return false;
+            }
+        }
+        if (keys.empty()) {
+            error = "top needs at least one sort key";
+            return false;
+        }
+        for (uint32_t row : manager.topK(keys, k, filter)) printHotel(hotels, row);
+    } else if (command == "skyline") {
+        HotelFilter filter;
+        SkylineWeights weights;
+        bool ranked = false;
+        for (size_t i = 1; i < words.size(); ++i) {
+            if (parseWeights(words[i], weights)) {
+                ranked = true;
+            } else if (!parseFilter(words[i], filter)) {
+                error = "bad filter or weights: " + words[i];
+                return false;
+            }
+        }
+        vector<uint32_t> rows = manager.skyline(filter);
+        if (ranked) rankSkyline(hotels, weights, rows);
+        for (uint32_t row : rows) printHotel(hotels, row);
+    } else if (command == "search" && words.size() >= 2) {
+        for (uint32_t row : manager.findByName(joinFrom(words, 1))) printHotel(hotels, row);
+    } else if (command == "prefix" && words.size() >= 2) {
+        NameSpan names = manager.getNameIndex().prefix(hotels, joinFrom(words, 1));
+        printNames(vector<uint32_t>(names.begin(), names.end()));
+    } else if (command == "substring" && words.size() >= 2) {
+        vector<uint32_t> names;
+        manager.getNameIndex().substring(hotels, joinFrom(words, 1), names);
+        printNames(names);
+    } else if (command == "fuzzy" && words.size() >= 3) {
+        int edits;
+        if (!parseNumber(words[1], edits) || edits < 0) {
+            error = "bad edit count: " + words[1];
+            return false;
+        }
+        vector<uint32_t> names;
+        manager.getNameIndex().fuzzy(hotels, joinFrom(words, 2), edits, names);
+        printNames(names);
+    } else if (command == "knapsack" && words.size() == 3) {
+        int budget;
+        float minRating;
+        if (!parseNumber(words[1], budget) || budget <= 0 || !parseNumber(words[2], minRating)) {
+            error = "usage: knapsack BUDGET MIN_RATING";
+            return false;
+        }
+        KnapsackResult best = recommender.bestCombination(hotels, budget, minRating);
+        for (uint32_t row : best.rows) printHotel(hotels, row);
+        cout << "total\t" << best.totalCost << '\t' << best.totalRating << '\n';
+    } else if (command == "add-hotel" && words.size() >= 5) {
+        int price;
+        float rating, distance;
+        HotelLocation location;
+        if (!parseNumber(words[2], price) || !parseNumber(words[3], rating) || !parseNumber(words[4], distance)
+            || !parseLocation(words, 5, location)) {
+            error = "usage: add-hotel NAME PRICE RATING DISTANCE [LAT LON [CITY]]";
+            return false;
+        }
+        cout << manager.addHotel(words[1], price, rating, distance, location) << '\n';
+    } else if ((command == "get" || command == "remove") && words.size() == 2) {
+        int id;
+        if (!parseHotelId(words[1], id)) {
+            error = "bad hotel ID: " + words[1];
+            return false;
+        }
+        size_t row = hotels.findId(id);
+        if (row == HotelTable::NONE) {
+            error = "no hotel H" + to_string(id);
+            return false;
+        }
+        printHotel(hotels, row);
+        if (command == "remove") manager.removeById(id);
+    } else if (command == "update" && words.size() >= 6) {
+        int id, price;
+        float rating, distance;
+        HotelLocation location;
+        if (!parseHotelId(words[1], id) || !parseNumber(words[3], price) || !parseNumber(words[4], rating)
+            || !parseNumber(words[5], distance) || !parseLocation(words, 6, location)) {
+            error = "usage: update ID NAME PRICE RATING DISTANCE [LAT LON [CITY]]";
+            return false;
+        }
+        Hotel values(id, words[2], price, rating, distance);
+        values.setCoordinates(location.latitude, location.longitude);
+        values.setCity(string(location.city));
+        if (!manager.updateById(id, values)) {
+            error = "no hotel H" + to_string(id);
+            return false;
+        }
+        printHotel(hotels, hotels.findId(id));
+    } else if ((command == "near" || command == "within") && words.size() >= 4) {
+        float latitude, longitude, km;
+        size_t k;
+        bool limited = command == "near" ? parseNumber(words[3], k) : parseNumber(words[3], km);
+        if (!parseNumber(words[1], latitude) || !parseNumber(words[2], longitude) || !limited) {
+            error = "usage: " + command + (command == "near" ? " LAT LON K" : " LAT LON KM") + " [FILTER]...";
+            return false;
+        }
+        HotelFilter filter;
+        for (size_t i = 4; i < words.size(); ++i) {
+            if (!parseFilter(words[i], filter)) {
+                error = "bad filter: " + words[i];
+                return false;
+            }
+        }
+        printHits(command == "near" ? manager.nearest(latitude, longitude, k, filter)
+                                    : manager.within(latitude, longitude, km, filter));
+    } else if (command == "by-road" && words.size() >= 3) {
+        float km;
+        if (!parseNumber(words[2], km)) {
+            error = "bad distance: " + words[2];
+            return false;
+        }
+        HotelFilter filter;
+        for (size_t i = 3; i < words.size(); ++i) {
+            if (!parseFilter(words[i], filter)) {
+                error = "bad filter: " + words[i];
+                return false;
+            }
+        }
+        if (graph.findCity(words[1]) < 0) {
+            error = "unknown city: " + words[1];
+            return false;
+        }
+        printHits(manager.withinByRoad(graph, words[1], km, filter));
+    } else if (command == "reload" && words.size() == 1) {
+        manager.readFromFile();
+        cout << manager.getHotels().liveCount() << " hotels\n";
+    } else if (command == "export-text" && words.size() == 2) {
+        if (!manager.exportText(words[1])) {
+            error = "could not write " + words[1];
+            return false;
+        }
+    } else if (command == "path" && words.size() == 4) {
+        float distance;
+        if (!parseNumber(words[3], distance)) {
+            error = "bad distance: " + words[3];
+            return false;
+        }
+        cout << graph.addPath(words[1], words[2], distance) << '\n';
+    } else if (command == "import-roads" && words.size() == 2) {
+        if (!graph.importRoads(words[1], error)) return false;
+        cout << graph.core.cityCount() << " cities\n";
+    } else if (command == "save-graph" && words.size() == 2) {
+        if (!graph.save(words[1])) {
+            error = "could not write " + words[1];
+            return false;
+        }
+    } else if (command == "load-graph" && words.size() == 2) {
+        if (!graph.load(words[1])) {
+            error = "not a graph snapshot: " + words[1];
+            return false;
+        }
+        cout << graph.core.cityCount() << " cities\n";
+    } else if (command == "route" && (words.size() == 3 || words.size() == 4)) {
+        RouteAlgorithm algorithm = RouteAlgorithm::Dijkstra;
+        if (words.size() == 4) {
+            if (words[3] == "bidirectional") algorithm = RouteAlgorithm::Bidirectional;
+            else if (words[3] == "alt") algorithm = RouteAlgorithm::Landmarks;
+            else if (words[3] == "ch") algorithm = RouteAlgorithm::Hierarchy;
+            else if (words[3] != "dijkstra") {
+                error = "unknown algorithm: " + words[3];
+                return false;
+            }
+        }
+        cout << graph.route(words[1], words[2], algorithm) << '\n';
+    } else if (command == "hierarchy" && words.size() <= 2) {
+        if (!graph.prepareHierarchy(words.size() == 2 ? words[1] : "")) {
+            error = "could not save hierarchy to " + words[1];
+            return false;
+        }
+        cout << graph.hierarchy.shortcutCount() << " shortcuts\n";
+    } else if (command == "routes" && words.size() >= 3) {
+        vector<RouteRequest> requests = {{words[1], vector<string>(words.begin() + 2, words.end())}};
+        RouteMatrix routes;
+        graph.routeBatch(requests, routes);
+        vector<int> path;
+        for (size_t c = 0; c < routes.columns(0); ++c) {
+            cout << words[1] << '\t' << words[c + 2] << '\t';
+            if (!routes.path(0, c, path)) {
+                cout << "unreachable\n";
+                continue;
+            }
+            cout << routes.distance(0, c) << '\t';
+            for (size_t i = 0; i < path.size(); ++i) cout << (i ? " " : "") << graph.core.cityName(path[i]);
+            cout << '\n';
+        }
+    } else if (command == "itinerary" && words.size() >= 3) {
+        ItineraryOptions options;
+        vector<string> stops;
+        for (size_t i = 2; i < words.size(); ++i) {
+            int ms;
+            if (words[i] == "round=yes" || words[i] == "round=no") {
+                options.returnToStart = words[i] == "round=yes";
+            } else if (words[i].compare(0, 7, "budget=") == 0) {
+                if (!parseNumber(words[i].substr(7), ms) || ms < 0) {
+                    error = "bad budget: " + words[i];
+                    return false;
+                }
+                options.budget = chrono::milliseconds(ms);
+            } else {
+                stops.push_back(words[i]);
+            }
+        }
+        Itinerary itinerary;
+        if (!graph.planItinerary(words[1], stops, options, itinerary, error)) return false;
+        cout << graph.formatItinerary(itinerary) << '\n';
+    } else if (command == "floyd" && words.size() == 1) {
+        cout << graph.floydWarshall();
+    } else if (command == "metrics" && words.size() == 1) {
+        cout << Metrics::global().toText();
+    } else {
+        error = "unknown command or wrong arguments: " + joinFrom(words, 0);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    string dataDir = ".";
+    string inputPath;
+    string metricsPath;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            cout << "Usage: " << argv[0] << " [--data DIR] [--metrics FILE] [FILE]\n\n" << USAGE
+                 << "\n--metrics FILE rewrites FILE with the metrics every few seconds and at exit;\n"
+                 << "it is JSON if FILE ends in .json, Prometheus text otherwise.\n";
+            return 0;
+        } else if (inputPath.empty()) {
+            inputPath = arg;
+        } else {
+            cerr << "Unexpected argument: " << arg << endl;
+            return 2;
+        }
+    }
+
+    ifstream file;
+    if (!inputPath.empty() && inputPath != "-") {
+        file.open(inputPath);
+        if (!file) {
+            cerr << "Unable to open " << inputPath << endl;
+            return 2;
+        }
+    }
+    istream& input = file.is_open() ? file : cin;
+    if (!metricsPath.empty()) Metrics::global().startDumping(metricsPath, chrono::seconds(5));
+
+    BatchSession session(dataDir);
+    int failures = 0;
+    string line;
+    for (int lineNumber = 1; getline(input, line); ++lineNumber) {
+        if (size_t comment = line.find('#'); comment != string::npos) line.erase(comment);
+        istringstream tokens(line);
+        vector<string> words;
+        for (string word; tokens >> word;) words.push_back(word);
+        if (words.empty()) continue;
+
+        string error;
+        if (!session.run(words, error)) {
+            cerr << "line " << lineNumber << ": " << error << endl;
+            ++failures;
+        }
+        cout << '\n' << flush;     // Blank line ends each command's output
+    }
+    Metrics::global().stopDumping();    // Writes the final figures
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+# Headless batch query driver, see cli.cpp for the command language
+QT -= core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = smarttravel-cli
+TEMPLATE = app
+
+include(core.pri)
+
+SOURCES += \
+    cli.cpp
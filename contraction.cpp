@@ -0,0 +1,466 @@
+#include "contraction.h"
+#include "asyncjob.h"
+#include "hotellog.h"
+#include "hotelstore.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace {
+
+// Witness searches give up after settling this many cities; a missed witness only costs a spare
+// shortcut. Estimating a priority can afford to be rougher than the contraction itself.
+const int MAX_WITNESS_SETTLED = 500;
+const int MAX_ESTIMATE_SETTLED = 10;
+
+// Contractions between cancellation checks
+const int CHECK_INTERVAL = 256;
+
+// On-disk layout (little-endian): header | rank int32[n] | upOffsets int32[n + 1] | up Edge[upEdges]
+//   | downOffsets int32[n + 1] | down Edge[downEdges]
+struct FileHeader {
+    char magic[8];              // "SMTCHIER"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t fingerprint;
+    uint64_t cities;
+    uint64_t upEdges;
+    uint64_t downEdges;
+};
+
+const uint32_t FILE_VERSION = 1;
+
+// FNV-1a over the city names and the edge arrays
+uint64_t fingerprintOf(const GraphCore& graph)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    };
+    for (int v = 0; v < graph.cityCount(); ++v) {
+        const string& name = graph.cityName(v);
+        mix(name.c_str(), name.size() + 1);
+    }
+    mix(graph.offsets().data(), graph.offsets().size() * sizeof(int));
+    mix(graph.targets().data(), graph.targets().size() * sizeof(int));
+    mix(graph.weights().data(), graph.weights().size() * sizeof(float));
+    return hash;
+}
+
+// The graph still being contracted, as adjacency lists in both directions
+class Contractor {
+public:
+    struct Arc {
+        int node;
+        float weight;
+        int middle;
+    };
+
+    vector<vector<Arc>> out, in;
+    vector<int> contractedNeighbours;
+
+    explicit Contractor(const GraphCore& graph);
+
+    // Edge difference of contracting v now, plus how many of its neighbours are gone already
+    int priority(int v);
+
+    // Removes v, moving its arcs into upward and downward and adding the shortcuts it needs
+    void contract(int v, vector<Arc>& upward, vector<Arc>& downward);
+
+private:
+    struct Shortcut {
+        int from, to;
+        float weight;
+    };
+
+    vector<float> dist;
+    vector<int> touched;
+    vector<uint32_t> mark;      // mark[w] == stamp while w is a target the witness search has not settled
+    uint32_t stamp = 0;
+    MinHeap heap;
+    vector<Shortcut> shortcuts;
+
+    void addArc(int from, int to, float weight, int middle);
+    void witnessSearch(int source, int avoid, float limit, int targets, int maxSettled);
+    void findShortcuts(int v, int maxSettled);
+};
+
+Contractor::Contractor(const GraphCore& graph)
+    : out(graph.cityCount()), in(graph.cityCount()), contractedNeighbours(graph.cityCount()),
+      dist(graph.cityCount(), GraphCore::INF), mark(graph.cityCount(), 0)
+{
+    heap.reset(graph.cityCount());
+    const vector<int>& offsets = graph.offsets();
+    for (int u = 0; u < graph.cityCount(); ++u) {
+        for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+            if (graph.targets()[k] != u) addArc(u, graph.targets()[k], graph.weights()[k], -1);
+        }
+    }
+}
+
+// Keeps one arc per pair, the shortest
+void Contractor::addArc(int from, int to, float weight, int middle)
+{
+    for (Arc& arc : out[from]) {
+        if (arc.node != to) continue;
+        if (weight < arc.weight) {
+            arc = {to, weight, middle};
+            for (Arc& back : in[to]) {
+                if (back.node == from) back = {from, weight, middle};
+            }
+        }
+        return;
+    }
+    out[from].push_back({to, weight, middle});
+    in[to].push_back({from, weight, middle});
+}
+
+// Dijkstra from source around avoid until every marked target is settled or the limits are hit
+void Contractor::witnessSearch(int source, int avoid, float limit, int targets, int maxSettled)
+{
+    for (int v : touched) dist[v] = GraphCore::INF;
+    touched.clear();
+    heap.clear();
+
+    dist[source] = 0;
+    touched.push_back(source);
+    heap.push(source, 0);
+    for (int settled = 0; targets > 0 && !heap.empty() && heap.topKey() <= limit && settled < maxSettled; ++settled) {
+        int u = heap.pop();
+        if (mark[u] == stamp) {
+            mark[u] = 0;
+            --targets;
+        }
+        for (const Arc& arc : out[u]) {
+            if (arc.node == avoid) continue;
+            float alt = dist[u] + arc.weight;
+            if (alt < dist[arc.node]) {
+                if (dist[arc.node] >= GraphCore::INF) touched.push_back(arc.node);
+                dist[arc.node] = alt;
+                heap.push(arc.node, alt);
+            }
+        }
+    }
+}
+
+// A shortcut u -> w replaces u -> v -> w unless a path avoiding v is no longer
+void Contractor::findShortcuts(int v, int maxSettled)
+{
+    shortcuts.clear();
+    for (const Arc& from : in[v]) {
+        if (++stamp == 0) {
+            fill(mark.begin(), mark.end(), 0);
+            stamp = 1;
+        }
+        float longest = -1;
+        int targets = 0;
+        for (const Arc& to : out[v]) {
+            if (to.node == from.node) continue;
+            longest = max(longest, to.weight);
+            mark[to.node] = stamp;
+            ++targets;
+        }
+        if (targets == 0) continue;
+
+        witnessSearch(from.node, v, from.weight + longest, targets, maxSettled);
+        for (const Arc& to : out[v]) {
+            float via = from.weight + to.weight;
+            if (to.node != from.node && dist[to.node] > via) shortcuts.push_back({from.node, to.node, via});
+        }
+    }
+}
+
+int Contractor::priority(int v)
+{
+    findShortcuts(v, MAX_ESTIMATE_SETTLED);
+    return (int)shortcuts.size() - (int)in[v].size() - (int)out[v].size() + contractedNeighbours[v];
+}
+
+void Contractor::contract(int v, vector<Arc>& upward, vector<Arc>& downward)
+{
+    findShortcuts(v, MAX_WITNESS_SETTLED);
+    upward = move(out[v]);
+    downward = move(in[v]);
+    out[v].clear();
+    in[v].clear();
+
+    auto unlink = [v](vector<Arc>& arcs) {
+        arcs.erase(remove_if(arcs.begin(), arcs.end(), [v](const Arc& arc) { return arc.node == v; }), arcs.end());
+    };
+    for (const Arc& arc : upward) {
+        unlink(in[arc.node]);
+        contractedNeighbours[arc.node]++;
+    }
+    for (const Arc& arc : downward) {
+        unlink(out[arc.node]);
+        contractedNeighbours[arc.node]++;
+    }
+    for (const Shortcut& shortcut : shortcuts) addArc(shortcut.from, shortcut.to, shortcut.weight, v);
+}
+
+} // namespace
+
+bool ContractionHierarchy::build(const GraphCore& graph, JobControl* job)
+{
+    clear();
+    int n = graph.cityCount();
+    Contractor contractor(graph);
+
+    // Cheapest contraction first; contracting a city changes only its neighbours' priorities,
+    // which are recomputed and queued again, leaving the old entries to be skipped
+    vector<int> priority(n);
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> queue;
+    for (int v = 0; v < n; ++v) {
+        priority[v] = contractor.priority(v);
+        queue.push({priority[v], v});
+    }
+
+    vector<int32_t> order(n, -1);
+    vector<vector<Contractor::Arc>> upward(n), downward(n);
+    int contracted = 0;
+    while (!queue.empty()) {
+        auto [key, v] = queue.top();
+        queue.pop();
+        if (order[v] >= 0 || key != priority[v]) continue;
+
+        order[v] = contracted++;
+        contractor.contract(v, upward[v], downward[v]);
+        for (const auto* arcs : {&upward[v], &downward[v]}) {
+            for (const Contractor::Arc& arc : *arcs) {
+                int next = contractor.priority(arc.node);
+                if (next != priority[arc.node]) {
+                    priority[arc.node] = next;
+                    queue.push({next, arc.node});
+                }
+            }
+        }
+        if (job && contracted % CHECK_INTERVAL == 0) {
+            if (job->isCancelled()) return false;
+            job->progress(contracted, n);
+        }
+    }
+
+    rank = move(order);
+    upOffsets.assign(n + 1, 0);
+    downOffsets.assign(n + 1, 0);
+    for (int v = 0; v < n; ++v) {
+        for (const Contractor::Arc& arc : upward[v]) up.push_back({arc.node, arc.weight, arc.middle});
+        for (const Contractor::Arc& arc : downward[v]) down.push_back({arc.node, arc.weight, arc.middle});
+        upOffsets[v + 1] = up.size();
+        downOffsets[v + 1] = down.size();
+    }
+    for (const Edge& edge : up) shortcuts += edge.middle >= 0;
+    for (const Edge& edge : down) shortcuts += edge.middle >= 0;
+
+    fingerprint = fingerprintOf(graph);
+    revision = graph.revision();
+    source = &graph;
+    return true;
+}
+
+void ContractionHierarchy::clear()
+{
+    rank.clear();
+    upOffsets.assign(1, 0);
+    up.clear();
+    downOffsets.assign(1, 0);
+    down.clear();
+    shortcuts = 0;
+    source = nullptr;
+}
+
+bool ContractionHierarchy::isCurrent(const GraphCore& graph) const
+{
+    return source == &graph && revision == graph.revision() && (int)rank.size() == graph.cityCount();
+}
+
+float ContractionHierarchy::route(int from, int to, vector<int>* path, int* settled) const
+{
+    QueryContext& context = QueryContext::local();
+    SearchScratch& forward = context.forward;
+    SearchScratch& backward = context.backward;
+    int n = rank.size();
+    forward.reset(n);
+    backward.reset(n);
+    forward.dist[from] = 0;
+    forward.touched.push_back(from);
+    forward.heap.push(from, 0);
+    backward.dist[to] = 0;
+    backward.touched.push_back(to);
+    backward.heap.push(to, 0);
+
+    // Both searches only climb in rank; each stops once its frontier can no longer beat the best meeting
+    float best = GraphCore::INF;
+    int meet = -1, count = 0;
+    while (true) {
+        bool forwardOpen = !forward.heap.empty() && forward.heap.topKey() < best;
+        bool backwardOpen = !backward.heap.empty() && backward.heap.topKey() < best;
+        if (!forwardOpen && !backwardOpen) break;
+
+        bool forwards = forwardOpen && (!backwardOpen || forward.heap.topKey() <= backward.heap.topKey());
+        SearchScratch& side = forwards ? forward : backward;
+        const SearchScratch& other = forwards ? backward : forward;
+        const vector<int32_t>& offsets = forwards ? upOffsets : downOffsets;
+        const vector<Edge>& edges = forwards ? up : down;
+        const vector<int32_t>& stallOffsets = forwards ? downOffsets : upOffsets;
+        const vector<Edge>& stallEdges = forwards ? down : up;
+
+        int u = side.heap.pop();
+        ++count;
+        float du = side.dist[u];
+        if (du + other.dist[u] < best) {
+            best = du + other.dist[u];
+            meet = u;
+        }
+
+        // Stall on demand: a higher city that reaches u more cheaply shows u is off every upward shortest path
+        bool stalled = false;
+        for (int k = stallOffsets[u]; k < stallOffsets[u + 1] && !stalled; ++k) {
+            stalled = side.dist[stallEdges[k].target] + stallEdges[k].weight < du;
+        }
+        if (stalled) continue;
+
+        for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+            int v = edges[k].target;
+            float alt = du + edges[k].weight;
+            if (alt < side.dist[v]) {
+                if (side.dist[v] >= GraphCore::INF) side.touched.push_back(v);
+                side.dist[v] = alt;
+                side.prev[v] = u;
+                side.heap.push(v, alt);
+            }
+        }
+    }
+    if (settled) *settled = count;
+    METRIC_ADD(NodesSettled, count);
+
+    if (path) {
+        path->clear();
+        if (meet >= 0) {
+            vector<int>& hops = context.hops;
+            hops.clear();
+            for (int at = meet; at != from; at = forward.prev[at]) hops.push_back(at);
+            hops.push_back(from);
+            reverse(hops.begin(), hops.end());
+            for (int at = meet; at != to; ) hops.push_back(at = backward.prev[at]);
+
+            path->push_back(from);
+            for (size_t i = 1; i < hops.size(); ++i) unpack(hops[i - 1], hops[i], *path);
+        }
+    }
+    return meet >= 0 ? best : GraphCore::INF;
+}
+
+const ContractionHierarchy::Edge* ContractionHierarchy::findEdge(int from, int to) const
+{
+    // Edges are stored at their lower-ranked end
+    const Edge* found = nullptr;
+    if (rank[from] < rank[to]) {
+        for (int k = upOffsets[from]; k < upOffsets[from + 1]; ++k) {
+            if (up[k].target == to && (!found || up[k].weight < found->weight)) found = &up[k];
+        }
+    } else {
+        for (int k = downOffsets[to]; k < downOffsets[to + 1]; ++k) {
+            if (down[k].target == from && (!found || down[k].weight < found->weight)) found = &down[k];
+        }
+    }
+    return found;
+}
+
+// Appends the cities after from on the road path a hierarchy edge stands for, ending with to
+void ContractionHierarchy::unpack(int from, int to, vector<int>& path) const
+{
+    vector<pair<int, int>>& pending = QueryContext::local().unpacking;
+    pending.assign(1, {from, to});
+    while (!pending.empty()) {
+        auto [a, b] = pending.back();
+        pending.pop_back();
+        const Edge* edge = findEdge(a, b);
+        if (edge->middle < 0) {
+            path.push_back(b);
+        } else {
+            pending.push_back({edge->middle, b});
+            pending.push_back({a, edge->middle});
+        }
+    }
+}
+
+bool ContractionHierarchy::save(const string& path) const
+{
+    FileHeader header{};
+    memcpy(header.magic, "SMTCHIER", 8);
+    header.version = FILE_VERSION;
+    header.fingerprint = fingerprint;
+    header.cities = rank.size();
+    header.upEdges = up.size();
+    header.downEdges = down.size();
+
+    string data;
+    auto put = [&](const void* bytes, size_t size) { data.append((const char*)bytes, size); };
+    put(&header, sizeof(header));
+    put(rank.data(), rank.size() * sizeof(int32_t));
+    put(upOffsets.data(), upOffsets.size() * sizeof(int32_t));
+    put(up.data(), up.size() * sizeof(Edge));
+    put(downOffsets.data(), downOffsets.size() * sizeof(int32_t));
+    put(down.data(), down.size() * sizeof(Edge));
+    return replaceFileSynced(path, data);
+}
+
+bool ContractionHierarchy::load(const string& path, const GraphCore& graph)
+{
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+    FileHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, "SMTCHIER", 8) != 0 || header.version != FILE_VERSION) return false;
+    if (header.cities != (uint64_t)graph.cityCount() || header.fingerprint != fingerprintOf(graph)) return false;
+
+    size_t n = header.cities;
+    size_t expected = sizeof(FileHeader) + n * sizeof(int32_t) + 2 * (n + 1) * sizeof(int32_t)
+                      + (header.upEdges + header.downEdges) * sizeof(Edge);
+    if (file.size() != expected) return false;
+
+    const char* at = file.data() + sizeof(FileHeader);
+    auto take = [&](auto& column, size_t count) {
+        column.resize(count);
+        memcpy(column.data(), at, count * sizeof(column[0]));
+        at += count * sizeof(column[0]);
+    };
+    clear();
+    take(rank, n);
+    take(upOffsets, n + 1);
+    take(up, header.upEdges);
+    take(downOffsets, n + 1);
+    take(down, header.downEdges);
+
+    // A damaged file of the right size must not send route() outside these arrays
+    auto validEdges = [&](const vector<int32_t>& offsets, const vector<Edge>& edges) {
+        if (offsets[0] != 0 || (size_t)offsets[n] != edges.size()) return false;
+        for (size_t v = 0; v < n; ++v) {
+            if (offsets[v] > offsets[v + 1]) return false;
+        }
+        for (const Edge& edge : edges) {
+            if (edge.target < 0 || (size_t)edge.target >= n || edge.middle < -1 || edge.middle >= (int64_t)n) return false;
+        }
+        return true;
+    };
+    vector<char> ranked(n, 0);
+    bool valid = validEdges(upOffsets, up) && validEdges(downOffsets, down);
+    for (size_t v = 0; v < n && valid; ++v) {
+        valid = rank[v] >= 0 && (size_t)rank[v] < n && !ranked[rank[v]];
+        if (valid) ranked[rank[v]] = 1;
+    }
+    if (!valid) {
+        clear();
+        return false;
+    }
+    for (const Edge& edge : up) shortcuts += edge.middle >= 0;
+    for (const Edge& edge : down) shortcuts += edge.middle >= 0;
+
+    fingerprint = header.fingerprint;
+    revision = graph.revision();
+    source = &graph;
+    return true;
+}
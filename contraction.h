@@ -0,0 +1,58 @@
+#ifndef CONTRACTION_H
+#define CONTRACTION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "graphcore.h"
+using namespace std;
+
+class JobControl;
+
+// Contraction hierarchy over a GraphCore: cities are ranked and contracted one by one, adding
+// shortcuts that keep every distance among the remaining cities. A query then searches only
+// upwards in rank from both ends, which settles a few hundred cities even on large road graphs.
+// The hierarchy describes the graph as it was built or loaded; any later edit makes it stale.
+// It suits sparse road networks: dense or expander-like graphs need many shortcuts and build slowly.
+class ContractionHierarchy {
+public:
+    // Contracts the whole graph; returns false (and stays empty) if job is cancelled
+    bool build(const GraphCore& graph, JobControl* job = nullptr);
+    void clear();
+
+    // True when built or loaded for graph and graph has not been edited since
+    bool isCurrent(const GraphCore& graph) const;
+    bool empty() const { return rank.empty(); }
+    size_t shortcutCount() const { return shortcuts; }
+
+    // Shortest path in the graph the hierarchy was built from; INF when unreachable.
+    // Safe to run concurrently; each thread keeps its own search buffers.
+    float route(int source, int target, vector<int>* path = nullptr, int* settled = nullptr) const;
+
+    // Binary file tied to the graph's contents: load() refuses a file built from any other graph
+    bool save(const string& path) const;
+    bool load(const string& path, const GraphCore& graph);
+
+private:
+    // An upward edge; middle is the contracted city a shortcut bypasses, -1 for a road
+    struct Edge {
+        int32_t target;
+        float weight;
+        int32_t middle;
+    };
+
+    vector<int32_t> rank;                       // Contraction order of each city
+    vector<int32_t> upOffsets{0};               // Edges v -> u with rank[u] > rank[v], by v
+    vector<Edge> up;
+    vector<int32_t> downOffsets{0};             // Edges u -> v with rank[u] > rank[v], by v; target is u
+    vector<Edge> down;
+    size_t shortcuts = 0;
+    uint64_t fingerprint = 0;                   // Of the graph's names and edges
+    uint64_t revision = 0;                      // GraphCore::revision() it matches
+    const GraphCore* source = nullptr;
+
+    const Edge* findEdge(int from, int to) const;
+    void unpack(int from, int to, vector<int>& path) const;
+};
+
+#endif // CONTRACTION_H
@@ -0,0 +1,16 @@
+# Links a target against smarttravelcore, built by core.pro into the same output directory
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CORE_LIB_DIR = $$OUT_PWD
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/release
+win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/debug
+
+LIBS += -L$$CORE_LIB_DIR -lsmarttravelcore
+win32-msvc*: PRE_TARGETDEPS += $$CORE_LIB_DIR/smarttravelcore.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libsmarttravelcore.a
+
+CONFIG += thread
+
+# Must match the library, which inlines the metric macros the same way
+no_metrics: DEFINES += SMARTTRAVEL_NO_METRICS
@@ -0,0 +1,59 @@
+# Qt-free engine library shared by the GUI (main.pro) and the command-line driver (cli.pro)
+QT -= core gui
+
+CONFIG += c++17 staticlib thread
+
+# qmake CONFIG+=no_metrics strips the timers and counters from the hot paths
+no_metrics: DEFINES += SMARTTRAVEL_NO_METRICS
+
+TARGET = smarttravelcore
+TEMPLATE = lib
+
+SOURCES += \
+    graph.cpp \
+    hotelmanager.cpp \
+    graphcore.cpp \
+    allpairs.cpp \
+    contraction.cpp \
+    graphstore.cpp \
+    routebatch.cpp \
+    threadpool.cpp \
+    asyncjob.cpp \
+    hotelstore.cpp \
+    hotellog.cpp \
+    metrics.cpp \
+    hoteltable.cpp \
+    hotelindex.cpp \
+    hotelsnapshot.cpp \
+    geoindex.cpp \
+    nameindex.cpp \
+    recommender.cpp \
+    topk.cpp \
+    skyline.cpp \
+    itinerary.cpp
+
+HEADERS += \
+    management.h \
+    hotel.h \
+    graph.h \
+    hotelmanager.h \
+    graphcore.h \
+    allpairs.h \
+    contraction.h \
+    graphstore.h \
+    routebatch.h \
+    threadpool.h \
+    asyncjob.h \
+    bitops.h \
+    hotelstore.h \
+    hotellog.h \
+    metrics.h \
+    hoteltable.h \
+    hotelindex.h \
+    hotelsnapshot.h \
+    geoindex.h \
+    nameindex.h \
+    recommender.h \
+    topk.h \
+    skyline.h \
+    itinerary.h
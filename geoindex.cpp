@@ -0,0 +1,266 @@
+#include "geoindex.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+const double EARTH_RADIUS = 6371.0;     // km
+const double PI = 3.14159265358979323846;
+
+// Squared chord length spanning an arc of km along the surface; arcs past half the globe are capped
+float chordSquared(float km)
+{
+    double angle = min((double)km / EARTH_RADIUS, PI);
+    double chord = 2 * EARTH_RADIUS * sin(angle / 2);
+    return (float)(chord * chord);
+}
+
+float arcKm(float chord2)
+{
+    double half = sqrt((double)chord2) / (2 * EARTH_RADIUS);
+    return (float)(2 * EARTH_RADIUS * asin(min(half, 1.0)));
+}
+
+float squaredDistance(float ax, float ay, float az, float bx, float by, float bz)
+{
+    float dx = ax - bx, dy = ay - by, dz = az - bz;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+void sortHits(vector<GeoHit>& hits)
+{
+    sort(hits.begin(), hits.end(), [](const GeoHit& a, const GeoHit& b) {
+        return a.km != b.km ? a.km < b.km : a.row < b.row;
+    });
+}
+
+// The tree is rebuilt once more rows than this plus the square root of its size are pending
+const size_t MIN_PENDING = 64;
+
+} // namespace
+
+bool GeoIndex::toPoint(const HotelTable& table, uint32_t row, Point& point)
+{
+    return toPoint(table.latitude(row), table.longitude(row), point);
+}
+
+bool GeoIndex::toPoint(float latitude, float longitude, Point& point)
+{
+    if (isnan(latitude) || isnan(longitude)) return false;
+    double phi = latitude * PI / 180, lambda = longitude * PI / 180;
+    point.x = (float)(EARTH_RADIUS * cos(phi) * cos(lambda));
+    point.y = (float)(EARTH_RADIUS * cos(phi) * sin(lambda));
+    point.z = (float)(EARTH_RADIUS * sin(phi));
+    return true;
+}
+
+void GeoIndex::rebuild(const HotelTable& table)
+{
+    vector<pair<Point, uint32_t>> entries;
+    state.clear();
+    state.resize(table.size(), Absent);
+    for (uint32_t row = 0; row < table.size(); ++row) {
+        Point point;
+        if (table.isLive(row) && toPoint(table, row, point)) {
+            entries.push_back({point, row});
+            state.set(row, InTree);
+        }
+    }
+    pending.clear();
+
+    // Median split on x, y, z in turn; the median lands in the middle of its range
+    auto build = [&](auto& self, size_t first, size_t last, int axis) -> void {
+        if (last - first < 2) return;
+        size_t mid = first + (last - first) / 2;
+        nth_element(entries.begin() + first, entries.begin() + mid, entries.begin() + last,
+                    [axis](const auto& a, const auto& b) { return (&a.first.x)[axis] < (&b.first.x)[axis]; });
+        self(self, first, mid, (axis + 1) % 3);
+        self(self, mid + 1, last, (axis + 1) % 3);
+    };
+    build(build, 0, entries.size(), 0);
+
+    auto next = make_shared<Tree>();
+    next->points.resize(entries.size());
+    next->rows.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        next->points[i] = entries[i].first;
+        next->rows[i] = entries[i].second;
+    }
+    tree = move(next);
+
+    cityRows.assign(table.cities().size(), nullptr);
+    for (uint32_t row = 0; row < table.size(); ++row) {
+        if (table.isLive(row) && table.cityId(row) != NamePool::NONE) writableCity(table.cityId(row)).push_back(row);
+    }
+}
+
+void GeoIndex::place(const HotelTable& table, uint32_t row)
+{
+    if (state.size() <= row) state.resize(row + 1, Absent);
+    bool listed = state[row] == Pending || state[row] == Listed;
+    Point point;
+    if (!toPoint(table, row, point)) {
+        state.set(row, listed ? Listed : Absent);
+        return;
+    }
+    if (!listed) pending.push_back(row);
+    if (state[row] != Pending) state.set(row, Pending);
+    if (pending.size() > MIN_PENDING + (size_t)sqrt((double)tree->points.size())) rebuild(table);
+}
+
+void GeoIndex::insert(const HotelTable& table, uint32_t row)
+{
+    place(table, row);
+    addToCity(table, row);
+}
+
+void GeoIndex::remove(const HotelTable& table, uint32_t row)
+{
+    if (row < state.size() && (state[row] == InTree || state[row] == Pending)) {
+        state.set(row, state[row] == Pending ? Listed : Absent);
+    }
+    removeFromCity(table, row);
+}
+
+void GeoIndex::addToCity(const HotelTable& table, uint32_t row)
+{
+    uint32_t city = table.cityId(row);
+    if (city == NamePool::NONE) return;
+    if (cityRows.size() <= city) cityRows.resize(city + 1);
+    vector<uint32_t>& rows = writableCity(city);
+    auto at = lower_bound(rows.begin(), rows.end(), row);
+    if (at == rows.end() || *at != row) rows.insert(at, row);
+}
+
+vector<uint32_t>& GeoIndex::writableCity(uint32_t city)
+{
+    // Published copies only read their lists (see ChunkedColumn)
+    shared_ptr<vector<uint32_t>>& rows = cityRows[city];
+    if (!rows) rows = make_shared<vector<uint32_t>>();
+    else if (rows.use_count() > 1) rows = make_shared<vector<uint32_t>>(*rows);
+    return *rows;
+}
+
+void GeoIndex::removeFromCity(const HotelTable& table, uint32_t row)
+{
+    uint32_t city = table.cityId(row);
+    if (city == NamePool::NONE || city >= cityRows.size() || !cityRows[city]) return;
+    const vector<uint32_t>& shared = *cityRows[city];
+    auto at = lower_bound(shared.begin(), shared.end(), row);
+    if (at == shared.end() || *at != row) return;
+    vector<uint32_t>& rows = writableCity(city);
+    rows.erase(rows.begin() + (at - shared.begin()));
+}
+
+RowSpan GeoIndex::rowsInCity(uint32_t cityId) const
+{
+    if (cityId >= cityRows.size() || !cityRows[cityId]) return {};
+    const vector<uint32_t>& rows = *cityRows[cityId];
+    return {rows.data(), rows.data() + rows.size()};
+}
+
+template <typename Visit>
+void GeoIndex::descend(size_t first, size_t last, int axis, const HotelTable& table, const Point& center,
+                       float& radius2, const HotelFilter& filter, Visit& visit) const
+{
+    while (first < last) {
+        size_t mid = first + (last - first) / 2;
+        const Point& p = tree->points[mid];
+        uint32_t row = tree->rows[mid];
+        float d2 = squaredDistance(p.x, p.y, p.z, center.x, center.y, center.z);
+        if (d2 <= radius2 && state[row] == InTree
+            && filter.matches(table.price(row), table.rating(row), table.distance(row))) {
+            visit(row, d2);
+        }
+
+        // Nearer half first so a shrinking radius can prune the farther one
+        float diff = (&center.x)[axis] - (&p.x)[axis];
+        int next = (axis + 1) % 3;
+        size_t nearFirst = diff < 0 ? first : mid + 1, nearLast = diff < 0 ? mid : last;
+        size_t farFirst = diff < 0 ? mid + 1 : first, farLast = diff < 0 ? last : mid;
+        descend(nearFirst, nearLast, next, table, center, radius2, filter, visit);
+        if (diff * diff > radius2) return;
+        first = farFirst;
+        last = farLast;
+        axis = next;
+    }
+}
+
+template <typename Visit>
+void GeoIndex::search(const HotelTable& table, const Point& center, float& radius2, const HotelFilter& filter,
+                      Visit visit) const
+{
+    descend(0, tree->points.size(), 0, table, center, radius2, filter, visit);
+    for (uint32_t row : pending) {
+        Point p;
+        if (state[row] != Pending || !toPoint(table, row, p)) continue;
+        float d2 = squaredDistance(p.x, p.y, p.z, center.x, center.y, center.z);
+        if (d2 <= radius2 && filter.matches(table.price(row), table.rating(row), table.distance(row))) visit(row, d2);
+    }
+}
+
+void GeoIndex::within(const HotelTable& table, float latitude, float longitude, float km, const HotelFilter& filter,
+                      vector<GeoHit>& out) const
+{
+    out.clear();
+    Point center;
+    if (!toPoint(latitude, longitude, center) || !(km >= 0)) return;
+
+    float radius2 = chordSquared(km);
+    search(table, center, radius2, filter, [&](uint32_t row, float d2) { out.push_back({row, d2}); });
+    for (GeoHit& hit : out) hit.km = arcKm(hit.km);
+    sortHits(out);
+}
+
+void GeoIndex::nearest(const HotelTable& table, float latitude, float longitude, size_t k, const HotelFilter& filter,
+                       vector<GeoHit>& out) const
+{
+    out.clear();
+    Point center;
+    if (!toPoint(latitude, longitude, center) || k == 0) return;
+
+    // Max-heap of the k closest so far; once full, its top bounds the search radius
+    auto farther = [](const GeoHit& a, const GeoHit& b) { return a.km != b.km ? a.km < b.km : a.row < b.row; };
+    priority_queue<GeoHit, vector<GeoHit>, decltype(farther)> best(farther);
+    float radius2 = INFINITY;
+    search(table, center, radius2, filter, [&](uint32_t row, float d2) {
+        GeoHit hit{row, d2};
+        if (best.size() < k) best.push(hit);
+        else if (farther(hit, best.top())) {
+            best.pop();
+            best.push(hit);
+        }
+        if (best.size() == k) radius2 = best.top().km;
+    });
+
+    out.resize(best.size());
+    for (size_t i = out.size(); i > 0; --i) {
+        out[i - 1] = best.top();
+        out[i - 1].km = arcKm(out[i - 1].km);
+        best.pop();
+    }
+}
+
+void withinByRoad(const GraphCore& graph, const HotelTable& table, const GeoIndex& geo, int city, float km,
+                  const HotelFilter& filter, vector<GeoHit>& out)
+{
+    out.clear();
+    if (city < 0 || city >= graph.cityCount() || !(km >= 0)) return;
+
+    SearchScratch& scratch = QueryContext::local().forward;
+    graph.searchWithin(city, km, scratch);
+    for (int reached : scratch.touched) {
+        float road = scratch.dist[reached];
+        if (road > km) continue;
+        uint32_t cityId = table.cities().find(graph.cityName(reached));
+        if (cityId == NamePool::NONE) continue;
+        for (uint32_t row : geo.rowsInCity(cityId)) {
+            float total = road + table.distance(row);
+            if (total <= km && filter.matches(table.price(row), table.rating(row), table.distance(row))) {
+                out.push_back({row, total});
+            }
+        }
+    }
+    sortHits(out);
+}
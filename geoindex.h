@@ -0,0 +1,80 @@
+#ifndef GEOINDEX_H
+#define GEOINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "hoteltable.h"
+#include "hotelindex.h"
+#include "graphcore.h"
+using namespace std;
+
+// A hotel found by a location query and how far away it is, km
+struct GeoHit {
+    uint32_t row;
+    float km;
+};
+
+// Spatial index over hotel coordinates, plus the hotels attached to each city.
+// Points sit on a sphere of the Earth's radius in a k-d tree; straight-line distance through the
+// sphere orders them exactly like great-circle distance, so the poles and the date line need no
+// special cases. Rows added or moved since the last build wait in a short list that queries scan,
+// and the writer rebuilds the tree once that list outgrows the square root of the tree's size.
+// Copies share the tree, the row state chunk by chunk and each city's rows, so publishing a snapshot
+// after an insert copies only the pending list and the parts the insert touched.
+class GeoIndex {
+public:
+    void rebuild(const HotelTable& table);
+    // A moved row is removed while it still holds its old location and inserted again afterwards
+    void insert(const HotelTable& table, uint32_t row);
+    void remove(const HotelTable& table, uint32_t row);
+
+    // Live rows matching filter within km of the point, nearest first
+    void within(const HotelTable& table, float latitude, float longitude, float km, const HotelFilter& filter,
+                vector<GeoHit>& out) const;
+
+    // The k live rows matching filter nearest to the point, nearest first
+    void nearest(const HotelTable& table, float latitude, float longitude, size_t k, const HotelFilter& filter,
+                 vector<GeoHit>& out) const;
+
+    // Live rows attached to a city (an id from HotelTable::cities()), ascending
+    RowSpan rowsInCity(uint32_t cityId) const;
+
+private:
+    struct Point { float x, y, z; };
+    // Listed is a row in pending that is not live, so placing it again must not list it twice
+    enum RowState : uint8_t { Absent, InTree, Pending, Listed };
+
+    struct Tree {
+        vector<Point> points;       // Implicit layout: each range's middle element is its node
+        vector<uint32_t> rows;      // Row of each point
+    };
+
+    shared_ptr<const Tree> tree = make_shared<Tree>();
+    vector<uint32_t> pending;       // Rows added or moved since the build
+    ChunkedColumn<uint8_t> state;   // RowState of every row; moved rows leave a dead entry in the tree
+    vector<shared_ptr<vector<uint32_t>>> cityRows;     // Null for a city without rows
+
+    vector<uint32_t>& writableCity(uint32_t city);
+
+    static bool toPoint(const HotelTable& table, uint32_t row, Point& point);
+    static bool toPoint(float latitude, float longitude, Point& point);
+    void place(const HotelTable& table, uint32_t row);
+    void addToCity(const HotelTable& table, uint32_t row);
+    void removeFromCity(const HotelTable& table, uint32_t row);
+
+    // Calls visit(row, squared chord) for every candidate closer than radius2, which visit may shrink
+    template <typename Visit>
+    void search(const HotelTable& table, const Point& center, float& radius2, const HotelFilter& filter, Visit visit) const;
+    template <typename Visit>
+    void descend(size_t first, size_t last, int axis, const HotelTable& table, const Point& center, float& radius2,
+                 const HotelFilter& filter, Visit& visit) const;
+};
+
+// Live rows matching filter that are at most km from city along the roads of graph, counting the
+// road distance to the hotel's own city plus the hotel's distance from that city's centre.
+// GeoHit::km is that total; nearest first. Only the part of the graph within km is searched.
+void withinByRoad(const GraphCore& graph, const HotelTable& table, const GeoIndex& geo, int city, float km,
+                  const HotelFilter& filter, vector<GeoHit>& out);
+
+#endif // GEOINDEX_H
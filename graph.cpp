@@ -0,0 +1,297 @@
+#include "graph.h"
+#include "asyncjob.h"
+#include "graphstore.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cstdio>
+
+// Formats like QString::number: %g with six significant digits. Short enough to stay in the string's
+// inline buffer, so the Floyd-Warshall table formats without a stream or an allocation per cell.
+static string formatNumber(float value)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%g", value);
+    return text;
+}
+
+static string lowercase(string text)
+{
+    transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text;
+}
+
+static string describeRoute(const GraphCore& core, const string& start, const string& end,
+                           float dist, const vector<int>& path)
+{
+    if (dist >= GraphCore::INF) {
+        return "Unable to reach " + end + " from " + start;
+    }
+
+    // Sized up front: the returned text is the query's one allocation
+    size_t length = 48;
+    for (int city : path) length += core.cityName(city).size() + 4;
+    string result;
+    result.reserve(length);
+    result += "Shortest distance: ";
+    result += formatNumber(dist);
+    result += " km\nPath: ";
+    for (size_t i = 0; i < path.size(); ++i) {
+        result += core.cityName(path[i]);
+        if (i < path.size() - 1) result += " -> ";
+    }
+    return result;
+}
+
+int Graph::findCity(const string& rawName) const
+{
+    return core.findCity(lowercase(rawName));
+}
+
+string Graph::addPath(const string& rawFrom, const string& rawTo, float distance)
+{
+    string from = lowercase(rawFrom);
+    string to = lowercase(rawTo);
+
+    int u = core.intern(from), v = core.intern(to);
+    cache.edgeChanged(core, u, v, distance, core.addEdge(u, v, distance));
+    cache.edgeChanged(core, v, u, distance, core.addEdge(v, u, distance));
+
+    return "Path added: " + from + " <-> " + to + " (" + formatNumber(distance) + " km)";
+}
+
+bool Graph::importRoads(const string& path, string& error, JobControl* job)
+{
+    if (!importEdgeList(path, core, error, &ThreadPool::shared(), job)) {
+        if (job && job->isCancelled()) error = "cancelled";
+        return false;
+    }
+    cache.invalidate();
+    return true;
+}
+
+bool Graph::save(const string& path) const
+{
+    return saveGraph(core, path);
+}
+
+bool Graph::load(const string& path)
+{
+    if (!loadGraph(path, core)) return false;
+    cache.invalidate();
+    return true;
+}
+
+string Graph::dijkstra(const string& rawStart, const string& rawEnd, JobControl* job)
+{
+    bool useHierarchy = !cache.isValid() && hierarchy.isCurrent(core);
+    return route(rawStart, rawEnd, useHierarchy ? RouteAlgorithm::Hierarchy : RouteAlgorithm::Dijkstra, job);
+}
+
+string Graph::route(const string& rawStart, const string& rawEnd, RouteAlgorithm algorithm, JobControl* job)
+{
+    METRIC_TIMER(Route);
+    string start = lowercase(rawStart), end = lowercase(rawEnd);
+
+    int s = core.findCity(start), t = core.findCity(end);
+    if (s < 0 || t < 0) {
+        return "The starting or ending city does not exist!";
+    }
+
+    // The cache keeps Floyd-Warshall's diagonal (self-loops count), so s == t is searched
+    vector<int>& path = QueryContext::local().path;
+    float dist;
+    if (algorithm == RouteAlgorithm::Dijkstra && cache.isValid() && s != t) {
+        cache.path(s, t, path);
+        dist = cache.distance(s, t);
+    } else if (algorithm == RouteAlgorithm::Hierarchy && hierarchy.isCurrent(core)) {
+        dist = hierarchy.route(s, t, &path);
+    } else {
+        dist = core.route(s, t, algorithm, &path, nullptr, job);
+    }
+    if (job && job->isCancelled()) return "";
+    return describeRoute(core, start, end, dist, path);
+}
+
+bool Graph::prepareHierarchy(const string& path, JobControl* job)
+{
+    if (!path.empty() && hierarchy.load(path, core)) return true;
+    if (!hierarchy.build(core, job)) return false;
+    return path.empty() || hierarchy.save(path);
+}
+
+string Graph::floydWarshall(JobControl* job)
+{
+    if (core.empty()) return "The figure is empty, and the Floyd-Warshall algorithm cannot be executed.";
+    METRIC_TIMER(FloydWarshall);
+
+    // Rows follow alphabetical city order, as the output always has
+    int n = core.cityCount();
+    vector<int> nodes(n);
+    for (int i = 0; i < n; ++i) nodes[i] = i;
+    sort(nodes.begin(), nodes.end(), [&](int a, int b) { return core.cityName(a) < core.cityName(b); });
+
+    // Reuse the cache when possible; graphs too large for it get a one-off matrix
+    DistanceMatrix dist;
+    if (!cache.isValid() && !cache.rebuild(core, &ThreadPool::shared(), job)) {
+        if (job && job->isCancelled()) return "";
+        if (!allPairsShortestPaths(core, dist, nodes, &ThreadPool::shared(), job)) return "";
+    }
+
+    string output = "=== Shortest paths between all cities (unit: km) ===\n\n\t";
+    for (int id : nodes) output += core.cityName(id) + "\t";
+    output += "\n";
+
+    for (int i = 0; i < n; ++i) {
+        output += core.cityName(nodes[i]) + ":\t";
+        for (int j = 0; j < n; ++j) {
+            float d = cache.isValid() ? cache.distance(nodes[i], nodes[j]) : dist.at(i, j);
+            output += (d >= 1e9f ? "INF" : formatNumber(d)) + "\t";
+            // If the distance is very large, treat it as infinity
+        }
+        output += "\n";
+    }
+
+    return output;
+}
+
+bool Graph::routeBatch(const vector<RouteRequest>& requests, RouteMatrix& result, bool keepPaths, JobControl* job)
+{
+    METRIC_TIMER(RouteBatch);
+    vector<RouteQuery> queries(requests.size());
+    for (size_t r = 0; r < requests.size(); ++r) {
+        queries[r].source = core.findCity(lowercase(requests[r].source));
+        for (const string& target : requests[r].targets) queries[r].targets.push_back(core.findCity(lowercase(target)));
+    }
+
+    if (!cache.isValid()) return ::routeBatch(core, queries, result, keepPaths, &ThreadPool::shared(), job);
+
+    result.reset(queries, keepPaths);
+    vector<int> path;
+    for (size_t r = 0; r < queries.size(); ++r) {
+        int s = queries[r].source;
+        for (size_t c = 0; s >= 0 && c < queries[r].targets.size(); ++c) {
+            int t = queries[r].targets[c];
+            if (t < 0) {
+                path.clear();
+                result.fill(r, c, GraphCore::INF, path);
+            } else if (s == t) {
+                // The cache keeps self-loops on its diagonal; a search starts at distance 0
+                path.assign(1, s);
+                result.fill(r, c, 0, path);
+            } else {
+                if (keepPaths) cache.path(s, t, path);
+                result.fill(r, c, cache.distance(s, t), path);
+            }
+        }
+    }
+    return true;
+}
+
+string Graph::formatRoutes(const vector<RouteRequest>& requests, const RouteMatrix& result) const
+{
+    string output;
+    vector<int> path;
+    for (size_t r = 0; r < requests.size(); ++r) {
+        string start = lowercase(requests[r].source);
+        for (size_t c = 0; c < requests[r].targets.size(); ++c) {
+            string end = lowercase(requests[r].targets[c]);
+            if (!output.empty()) output += "\n\n";
+            output += start + " -> " + end + "\n";
+            if (core.findCity(start) < 0 || core.findCity(end) < 0) {
+                output += "The starting or ending city does not exist!";
+                continue;
+            }
+            result.path(r, c, path);
+            output += describeRoute(core, start, end, result.distance(r, c), path);
+        }
+    }
+    return output;
+}
+
+bool Graph::planItinerary(const string& rawStart, const vector<string>& rawStops, const ItineraryOptions& options,
+                          Itinerary& result, string& error, JobControl* job)
+{
+    METRIC_TIMER(Itinerary);
+    result = Itinerary();
+
+    // Place 0 is the start; a stop named twice, or naming the start, adds nothing
+    vector<int> places;
+    for (size_t i = 0; i <= rawStops.size(); ++i) {
+        const string& name = i == 0 ? rawStart : rawStops[i - 1];
+        int city = findCity(name);
+        if (city < 0) {
+            error = "unknown city: " + lowercase(name);
+            return false;
+        }
+        if (find(places.begin(), places.end(), city) == places.end()) places.push_back(city);
+    }
+
+    // Leg distances between every pair of places
+    int n = places.size();
+    vector<float> dist((size_t)n * n, 0);
+    if (cache.isValid()) {
+        for (int a = 0; a < n; ++a) {
+            for (int b = 0; b < n; ++b) {
+                if (a != b) dist[(size_t)a * n + b] = cache.distance(places[a], places[b]);
+            }
+        }
+    } else {
+        vector<RouteQuery> queries(n, RouteQuery{0, places});
+        for (int a = 0; a < n; ++a) queries[a].source = places[a];
+        RouteMatrix legs;
+        if (!::routeBatch(core, queries, legs, false, &ThreadPool::shared(), job)) {
+            error = "cancelled";
+            return false;
+        }
+        for (int a = 0; a < n; ++a) {
+            for (int b = 0; b < n; ++b) {
+                if (a != b) dist[(size_t)a * n + b] = legs.distance(a, b);
+            }
+        }
+    }
+
+    vector<int> order;
+    if (!planTour(dist, n, options, order, result.distance, result.exact, &ThreadPool::shared(), job)) {
+        error = "cancelled";
+        return false;
+    }
+    if (result.distance >= GraphCore::INF) {
+        error = "some stops cannot be reached from the others";
+        return false;
+    }
+
+    result.stops.push_back(places[0]);
+    for (int place : order) result.stops.push_back(places[place]);
+    if (options.returnToStart && n > 1) result.stops.push_back(places[0]);
+
+    // Expand each leg into its roads, dropping the city the previous leg ended on
+    result.path.assign(1, places[0]);
+    vector<int>& leg = QueryContext::local().path;
+    for (size_t i = 1; i < result.stops.size(); ++i) {
+        int from = result.stops[i - 1], to = result.stops[i];
+        if (cache.isValid()) cache.path(from, to, leg);
+        else core.route(from, to, RouteAlgorithm::Dijkstra, &leg, nullptr, job);
+        if (job && job->isCancelled()) {
+            error = "cancelled";
+            return false;
+        }
+        result.path.insert(result.path.end(), leg.begin() + 1, leg.end());
+    }
+    return true;
+}
+
+string Graph::formatItinerary(const Itinerary& itinerary) const
+{
+    string output = itinerary.exact ? "Shortest itinerary: " : "Best itinerary found: ";
+    output += formatNumber(itinerary.distance) + " km\nStops: ";
+    for (size_t i = 0; i < itinerary.stops.size(); ++i) {
+        if (i) output += " -> ";
+        output += core.cityName(itinerary.stops[i]);
+    }
+    output += "\nPath: ";
+    for (size_t i = 0; i < itinerary.path.size(); ++i) {
+        if (i) output += " -> ";
+        output += core.cityName(itinerary.path[i]);
+    }
+    return output;
+}
@@ -0,0 +1,77 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <string>
+#include "graphcore.h"
+#include "allpairs.h"
+#include "contraction.h"
+#include "routebatch.h"
+#include "itinerary.h"
+using namespace std;
+
+// Routes from one city to several, by name
+struct RouteRequest {
+    string source;
+    vector<string> targets;
+};
+
+// A tour through several cities, by city id
+struct Itinerary {
+    vector<int> stops;      // Visiting order: the start, every stop once, and the start again on a round trip
+    vector<int> path;       // Every city passed on the way
+    float distance = GraphCore::INF;
+    bool exact = false;     // Proven shortest; otherwise the best the local search found in its budget
+};
+
+class Graph {
+public:
+    GraphCore core;     // Interned, CSR-backed engine that answers the queries
+    PathCache cache;    // All-pairs results, built by floydWarshall() and repaired on every addPath
+    ContractionHierarchy hierarchy;     // Optional, see prepareHierarchy(); ignored once the graph is edited
+
+    bool empty() const { return core.empty(); }
+    int findCity(const string& rawName) const;      // Matches names as dijkstra() does; -1 if unknown
+
+    // City names are lowercased; the path is added in both directions
+    string addPath(const string& rawFrom, const string& rawTo, float distance);
+
+    // Adds every road of a CSV/TSV edge list as addPath would (see importEdgeList in graphstore.h).
+    // Returns false with error set if the file is unreadable or malformed, or if job was cancelled.
+    bool importRoads(const string& path, string& error, JobControl* job = nullptr);
+
+    // Binary snapshot of the whole graph; load() replaces it, leaving it unchanged on failure
+    bool save(const string& path) const;
+    bool load(const string& path);
+
+    // Human-readable reports, as shown by the GUI and the CLI.
+    // A cancelled job gets an empty string. route() runs the algorithm asked for, except that a
+    // Dijkstra request is answered from the all-pairs cache while it is valid. dijkstra() takes the
+    // fastest exact answer: the cache, else the hierarchy while it is current, else Dijkstra.
+    string dijkstra(const string& rawStart, const string& rawEnd, JobControl* job = nullptr);
+    string route(const string& rawStart, const string& rawEnd, RouteAlgorithm algorithm, JobControl* job = nullptr);
+
+    // Loads the contraction hierarchy from path if the file was built from this exact graph,
+    // otherwise builds it and, given a path, saves it there for the next start.
+    // Returns false if job was cancelled or the file could not be written.
+    bool prepareHierarchy(const string& path = "", JobControl* job = nullptr);
+    string floydWarshall(JobControl* job = nullptr);
+
+    // Numeric answers for many routes at once: read from the all-pairs cache when it is valid,
+    // otherwise from parallel one-to-many searches. Names match as in dijkstra(); unknown cities
+    // are unreachable. Returns false if job was cancelled.
+    bool routeBatch(const vector<RouteRequest>& requests, RouteMatrix& result, bool keepPaths = true,
+                    JobControl* job = nullptr);
+
+    // Shortest tour from start through every stop (see planTour in itinerary.h), over distances read
+    // from the all-pairs cache when it is valid and from one-to-many searches otherwise. Names match
+    // as in dijkstra(); repeated stops are visited once. Returns false with error set for an unknown
+    // city, stops that cannot all be reached, or a cancelled job.
+    bool planItinerary(const string& rawStart, const vector<string>& rawStops, const ItineraryOptions& options,
+                       Itinerary& result, string& error, JobControl* job = nullptr);
+    string formatItinerary(const Itinerary& itinerary) const;
+
+    // dijkstra()'s report for every cell of a routeBatch result, separated by blank lines
+    string formatRoutes(const vector<RouteRequest>& requests, const RouteMatrix& result) const;
+};
+
+#endif // GRAPH_H
@@ -0,0 +1,604 @@
+#include "graphcore.h"
+#include "asyncjob.h"
+#include "metrics.h"
+#include <algorithm>
+
+// Nodes settled between cancellation checks in route
+static const int CHECK_INTERVAL = 4096;
+
+// Landmarks consulted per Landmarks query: those giving the tightest bound between its two ends
+static const int ACTIVE_LANDMARKS = 4;
+
+void MinHeap::reset(int nodeCount)
+{
+    heap.clear();
+    pos.assign(nodeCount, -1);
+    keys.resize(nodeCount);
+}
+
+void MinHeap::push(int node, float key)
+{
+    keys[node] = key;
+    if (pos[node] < 0) {
+        pos[node] = heap.size();
+        heap.push_back(node);
+    }
+    siftUp(pos[node]);
+}
+
+void MinHeap::clear()
+{
+    for (int node : heap) pos[node] = -1;
+    heap.clear();
+}
+
+int MinHeap::pop()
+{
+    int top = heap[0];
+    pos[top] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heap[0] = last;
+        pos[last] = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+void MinHeap::siftUp(int slot)
+{
+    int node = heap[slot];
+    float key = keys[node];
+    while (slot > 0) {
+        int parent = (slot - 1) / 2;
+        if (keys[heap[parent]] <= key) break;
+        heap[slot] = heap[parent];
+        pos[heap[slot]] = slot;
+        slot = parent;
+    }
+    heap[slot] = node;
+    pos[node] = slot;
+}
+
+void MinHeap::siftDown(int slot)
+{
+    int n = heap.size();
+    int node = heap[slot];
+    float key = keys[node];
+    while (true) {
+        int child = 2 * slot + 1;
+        if (child >= n) break;
+        if (child + 1 < n && keys[heap[child + 1]] < keys[heap[child]]) child++;
+        if (keys[heap[child]] >= key) break;
+        heap[slot] = heap[child];
+        pos[heap[slot]] = slot;
+        slot = child;
+    }
+    heap[slot] = node;
+    pos[node] = slot;
+}
+
+// The slot of a name index holding name, or the empty slot where it belongs
+static size_t findSlot(const vector<int>& nameSlots, const vector<string>& names, const string& name)
+{
+    size_t mask = nameSlots.size() - 1;
+    for (size_t slot = hash<string>()(name) & mask;; slot = (slot + 1) & mask) {
+        if (nameSlots[slot] < 0 || names[nameSlots[slot]] == name) return slot;
+    }
+}
+
+void GraphCore::rehash(size_t slotCount)
+{
+    nameSlots.assign(slotCount, -1);
+    for (int id = 0; id < (int)names.size(); ++id) nameSlots[findSlot(nameSlots, names, names[id])] = id;
+}
+
+int GraphCore::intern(const string& name)
+{
+    if (nameSlots.empty()) rehash(16);
+    size_t slot = findSlot(nameSlots, names, name);
+    if (nameSlots[slot] >= 0) return nameSlots[slot];
+
+    stage();
+    int id = names.size();
+    names.push_back(name);
+    nameSlots[slot] = id;
+    if (names.size() * 2 > nameSlots.size()) rehash(nameSlots.size() * 2);
+    firstBlock.push_back(-1);
+    lastBlock.push_back(-1);
+    dirty = true;
+    ++edits;
+    landmarksStale = true;
+    return id;
+}
+
+int GraphCore::findCity(const string& name) const
+{
+    return nameSlots.empty() ? -1 : nameSlots[findSlot(nameSlots, names, name)];
+}
+
+float GraphCore::addEdge(int from, int to, float distance)
+{
+    stage();
+    for (int b = firstBlock[from]; b >= 0; b = edgeBlocks[b].next) {
+        EdgeBlock& block = edgeBlocks[b];
+        for (int i = 0; i < block.count; ++i) {
+            if (block.targets[i] == to) {
+                float previous = block.weights[i];
+                block.weights[i] = distance;
+                dirty = true;
+                ++edits;
+                landmarksStale = true;
+                return previous;
+            }
+        }
+    }
+    appendEdge(from, to, distance);
+    dirty = true;
+    ++edits;
+    landmarksStale = true;
+    return INF;
+}
+
+void GraphCore::build() const
+{
+    if (!dirty) return;
+
+    int n = names.size();
+    csrOffsets.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        int degree = 0;
+        for (int b = firstBlock[u]; b >= 0; b = edgeBlocks[b].next) degree += edgeBlocks[b].count;
+        csrOffsets[u + 1] = csrOffsets[u] + degree;
+    }
+
+    csrTargets.resize(csrOffsets[n]);
+    csrWeights.resize(csrOffsets[n]);
+    for (int u = 0; u < n; ++u) {
+        int k = csrOffsets[u];
+        for (int b = firstBlock[u]; b >= 0; b = edgeBlocks[b].next) {
+            const EdgeBlock& block = edgeBlocks[b];
+            copy_n(block.targets, block.count, &csrTargets[k]);
+            copy_n(block.weights, block.count, &csrWeights[k]);
+            k += block.count;
+        }
+    }
+    buildReverse();
+    dirty = false;
+}
+
+void GraphCore::buildReverse() const
+{
+    int n = names.size();
+    reverseOffsets.assign(n + 1, 0);
+    for (int v : csrTargets) reverseOffsets[v + 1]++;
+    for (int v = 0; v < n; ++v) reverseOffsets[v + 1] += reverseOffsets[v];
+    reverseTargets.resize(csrTargets.size());
+    reverseWeights.resize(csrWeights.size());
+    vector<int> next(reverseOffsets.begin(), reverseOffsets.end() - 1);
+    for (int u = 0; u < n; ++u) {
+        for (int k = csrOffsets[u]; k < csrOffsets[u + 1]; ++k) {
+            int slot = next[csrTargets[k]]++;
+            reverseTargets[slot] = u;
+            reverseWeights[slot] = csrWeights[k];
+        }
+    }
+}
+
+bool GraphCore::assign(vector<string> cityNames, vector<int> offsets, vector<int> targets, vector<float> weights)
+{
+    size_t n = cityNames.size();
+    if (offsets.size() != n + 1 || offsets[0] != 0 || (size_t)offsets[n] != targets.size()
+        || weights.size() != targets.size()) {
+        return false;
+    }
+    for (size_t u = 0; u < n; ++u) {
+        if (offsets[u] > offsets[u + 1]) return false;
+    }
+    for (int v : targets) {
+        if (v < 0 || (size_t)v >= n) return false;
+    }
+    size_t slotCount = 16;
+    while (n * 2 > slotCount) slotCount *= 2;
+    vector<int> index(slotCount, -1);
+    for (size_t id = 0; id < n; ++id) {
+        size_t slot = findSlot(index, cityNames, cityNames[id]);
+        if (index[slot] >= 0) return false;
+        index[slot] = id;
+    }
+
+    names = move(cityNames);
+    nameSlots = move(index);
+    vector<EdgeBlock>().swap(edgeBlocks);  // The CSR is the source of truth until the next edit
+    firstBlock.clear();
+    lastBlock.clear();
+    staged = false;
+    csrOffsets = move(offsets);
+    csrTargets = move(targets);
+    csrWeights = move(weights);
+    buildReverse();
+    dirty = false;
+    ++edits;
+    landmarksStale = true;
+    return true;
+}
+
+void GraphCore::stage()
+{
+    if (staged) return;
+    int n = names.size();
+    size_t blocks = 0;
+    for (int u = 0; u < n; ++u) blocks += (csrOffsets[u + 1] - csrOffsets[u] + EdgeBlock::CAPACITY - 1) / EdgeBlock::CAPACITY;
+    edgeBlocks.clear();
+    edgeBlocks.reserve(blocks);
+    firstBlock.assign(n, -1);
+    lastBlock.assign(n, -1);
+    for (int u = 0; u < n; ++u) {
+        for (int k = csrOffsets[u]; k < csrOffsets[u + 1]; ++k) appendEdge(u, csrTargets[k], csrWeights[k]);
+    }
+    staged = true;
+}
+
+void GraphCore::appendEdge(int from, int to, float distance)
+{
+    int b = lastBlock[from];
+    if (b < 0 || edgeBlocks[b].count == EdgeBlock::CAPACITY) {
+        int fresh = edgeBlocks.size();
+        edgeBlocks.emplace_back();
+        if (b < 0) firstBlock[from] = fresh;
+        else edgeBlocks[b].next = fresh;
+        lastBlock[from] = b = fresh;
+    }
+    EdgeBlock& block = edgeBlocks[b];
+    block.targets[block.count] = to;
+    block.weights[block.count] = distance;
+    ++block.count;
+}
+
+float GraphCore::shortestPath(int source, int target, vector<int>* path, JobControl* job) const
+{
+    return route(source, target, RouteAlgorithm::Dijkstra, path, nullptr, job);
+}
+
+void SearchScratch::reset(int n)
+{
+    if ((int)dist.size() != n) {
+        dist.assign(n, GraphCore::INF);
+        prev.assign(n, -1);
+        mark.assign(n, 0);
+        stamp = 0;
+        touched.clear();
+        METRIC_ADD(BufferAllocations, 1);
+    }
+    for (int v : touched) {
+        dist[v] = GraphCore::INF;
+        prev[v] = -1;
+    }
+    touched.clear();
+    if (heap.capacity() != n) heap.reset(n);
+    else heap.clear();
+}
+
+QueryContext& QueryContext::local()
+{
+    thread_local QueryContext context;
+    return context;
+}
+
+void GraphCore::searchMany(int source, const int* targets, size_t count, SearchScratch& scratch) const
+{
+    build();
+    scratch.reset(names.size());
+    int n = names.size();
+
+    // A new stamp unmarks every previous target at once
+    if (++scratch.stamp == 0) {
+        fill(scratch.mark.begin(), scratch.mark.end(), 0);
+        scratch.stamp = 1;
+    }
+    size_t pending = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int t = targets[i];
+        if (t >= 0 && t < n && scratch.mark[t] != scratch.stamp) {
+            scratch.mark[t] = scratch.stamp;
+            ++pending;
+        }
+    }
+
+    vector<float>& dist = scratch.dist;
+    vector<int>& prev = scratch.prev;
+    MinHeap& heap = scratch.heap;
+    dist[source] = 0;
+    scratch.touched.push_back(source);
+    heap.push(source, 0);
+
+    uint64_t settled = 0;
+    while (pending > 0 && !heap.empty()) {
+        int u = heap.pop();
+        ++settled;
+        if (scratch.mark[u] == scratch.stamp) {
+            scratch.mark[u] = 0;
+            --pending;
+        }
+
+        float du = dist[u];
+        for (int k = csrOffsets[u]; k < csrOffsets[u + 1]; ++k) {
+            int v = csrTargets[k];
+            float alt = du + csrWeights[k];
+            if (alt < dist[v]) {
+                if (dist[v] >= INF) scratch.touched.push_back(v);
+                dist[v] = alt;
+                prev[v] = u;
+                heap.push(v, alt);
+            }
+        }
+    }
+    METRIC_ADD(NodesSettled, settled);
+}
+
+void GraphCore::searchWithin(int source, float limit, SearchScratch& scratch) const
+{
+    build();
+    scratch.reset(names.size());
+
+    vector<float>& dist = scratch.dist;
+    MinHeap& heap = scratch.heap;
+    dist[source] = 0;
+    scratch.touched.push_back(source);
+    heap.push(source, 0);
+
+    uint64_t settled = 0;
+    while (!heap.empty() && heap.topKey() <= limit) {
+        int u = heap.pop();
+        ++settled;
+        float du = dist[u];
+        for (int k = csrOffsets[u]; k < csrOffsets[u + 1]; ++k) {
+            int v = csrTargets[k];
+            float alt = du + csrWeights[k];
+            if (alt < dist[v]) {
+                if (dist[v] >= INF) scratch.touched.push_back(v);
+                dist[v] = alt;
+                scratch.prev[v] = u;
+                heap.push(v, alt);
+            }
+        }
+    }
+    METRIC_ADD(NodesSettled, settled);
+}
+
+void GraphCore::distancesFrom(int source, bool backward, vector<float>& dist) const
+{
+    const vector<int>& offsets = backward ? reverseOffsets : csrOffsets;
+    const vector<int>& targets = backward ? reverseTargets : csrTargets;
+    const vector<float>& weights = backward ? reverseWeights : csrWeights;
+
+    int n = names.size();
+    dist.assign(n, INF);
+    MinHeap queue;
+    queue.reset(n);
+    dist[source] = 0;
+    queue.push(source, 0);
+    while (!queue.empty()) {
+        int u = queue.pop();
+        for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+            int v = targets[k];
+            float alt = dist[u] + weights[k];
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                queue.push(v, alt);
+            }
+        }
+    }
+}
+
+bool GraphCore::buildLandmarks(int count, JobControl* job) const
+{
+    build();
+    int n = names.size();
+    count = min(count, n);
+
+    vector<int> chosen;
+    vector<float> from((size_t)n * count), to((size_t)n * count);
+    vector<float> nearest(n, INF), dist;    // nearest: distance from the closest landmark so far
+
+    // Start from the city farthest from city 0, then keep taking the one farthest from every landmark.
+    // Cities no landmark reaches count as farthest, so each component gets one.
+    int next = 0;
+    if (n > 0) {
+        distancesFrom(0, false, dist);
+        next = max_element(dist.begin(), dist.end()) - dist.begin();
+    }
+    for (int i = 0; i < count; ++i) {
+        if (job && job->isCancelled()) return false;
+        chosen.push_back(next);
+        distancesFrom(next, false, dist);
+        for (int v = 0; v < n; ++v) {
+            from[(size_t)v * count + i] = dist[v];
+            nearest[v] = min(nearest[v], dist[v]);
+        }
+        distancesFrom(next, true, dist);
+        for (int v = 0; v < n; ++v) to[(size_t)v * count + i] = dist[v];
+        next = max_element(nearest.begin(), nearest.end()) - nearest.begin();
+        if (job) job->progress(i + 1, count);
+    }
+
+    landmarks = move(chosen);
+    fromLandmark = move(from);
+    toLandmark = move(to);
+    landmarksStale = false;
+    return true;
+}
+
+template <typename Potential>
+int GraphCore::searchTowards(int source, int target, Potential potential, SearchScratch& scratch,
+                             JobControl* job) const
+{
+    scratch.reset(names.size());
+    vector<float>& dist = scratch.dist;
+    MinHeap& queue = scratch.heap;
+    dist[source] = 0;
+    scratch.touched.push_back(source);
+    queue.push(source, potential(source));
+
+    int settled = 0;
+    while (!queue.empty()) {
+        int u = queue.pop();
+        ++settled;
+        if (u == target) break;
+        if (job && settled % CHECK_INTERVAL == 0) {
+            if (job->isCancelled()) break;
+            job->progress(settled, names.size());
+        }
+
+        float du = dist[u];
+        for (int k = csrOffsets[u]; k < csrOffsets[u + 1]; ++k) {
+            int v = csrTargets[k];
+            float alt = du + csrWeights[k];
+            if (alt < dist[v]) {
+                if (dist[v] >= INF) scratch.touched.push_back(v);
+                dist[v] = alt;
+                scratch.prev[v] = u;
+                queue.push(v, alt + potential(v));
+            }
+        }
+    }
+    return settled;
+}
+
+int GraphCore::searchBidirectional(int source, int target, SearchScratch& forward, SearchScratch& backward,
+                                   int& meet, float& best, JobControl* job) const
+{
+    forward.reset(names.size());
+    backward.reset(names.size());
+    forward.dist[source] = 0;
+    forward.touched.push_back(source);
+    forward.heap.push(source, 0);
+    backward.dist[target] = 0;
+    backward.touched.push_back(target);
+    backward.heap.push(target, 0);
+    meet = source == target ? source : -1;
+    best = source == target ? 0 : INF;
+
+    // Once one side runs dry every path it could extend has been offered as a meeting
+    int settled = 0;
+    while (!forward.heap.empty() && !backward.heap.empty()) {
+        float forwardKey = forward.heap.topKey(), backwardKey = backward.heap.topKey();
+        if (forwardKey + backwardKey >= best) break;
+        ++settled;
+        if (job && settled % CHECK_INTERVAL == 0) {
+            if (job->isCancelled()) break;
+            job->progress(settled, names.size());
+        }
+
+        // Grow the side with the smaller radius; backwards means following edges in reverse
+        bool forwards = forwardKey <= backwardKey;
+        SearchScratch& side = forwards ? forward : backward;
+        const SearchScratch& other = forwards ? backward : forward;
+        const vector<int>& offsets = forwards ? csrOffsets : reverseOffsets;
+        const vector<int>& targets = forwards ? csrTargets : reverseTargets;
+        const vector<float>& weights = forwards ? csrWeights : reverseWeights;
+
+        int u = side.heap.pop();
+        float du = side.dist[u];
+        for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+            int v = targets[k];
+            float alt = du + weights[k];
+            if (alt < side.dist[v]) {
+                if (side.dist[v] >= INF) side.touched.push_back(v);
+                side.dist[v] = alt;
+                side.prev[v] = u;
+                side.heap.push(v, alt);
+            }
+            if (alt + other.dist[v] < best) {
+                best = alt + other.dist[v];
+                meet = v;
+            }
+        }
+    }
+    return settled;
+}
+
+float GraphCore::route(int source, int target, RouteAlgorithm algorithm, vector<int>* path, int* settled,
+                       JobControl* job) const
+{
+    build();
+    QueryContext& context = QueryContext::local();
+    SearchScratch& forward = context.forward;
+    SearchScratch& backward = context.backward;
+
+    int count = 0;
+    float dist = INF;
+    if (path) path->clear();
+
+    if (algorithm == RouteAlgorithm::Bidirectional) {
+        int meet;
+        count = searchBidirectional(source, target, forward, backward, meet, dist, job);
+        if (path && meet >= 0 && dist < INF) {
+            for (int at = meet; at != source; at = forward.prev[at]) path->push_back(at);
+            path->push_back(source);
+            reverse(path->begin(), path->end());
+            for (int at = meet; at != target; ) path->push_back(at = backward.prev[at]);
+        }
+    } else {
+        if (algorithm == RouteAlgorithm::Landmarks && landmarksStale && !buildLandmarks(DEFAULT_LANDMARKS, job)) {
+            return INF;
+        }
+
+        // Use the landmarks that bound this pair's distance most tightly. Each gives
+        // dist(v, t) >= max(d(L, t) - d(L, v), d(v, L) - d(t, L)); with unreachable
+        // distances at INF a bound near INF proves t unreachable from v.
+        int active[ACTIVE_LANDMARKS];
+        int activeCount = 0;
+        size_t stride = landmarks.size();
+        if (algorithm == RouteAlgorithm::Landmarks) {
+            const float* fromT = &fromLandmark[(size_t)target * stride];
+            const float* toT = &toLandmark[(size_t)target * stride];
+            const float* fromS = &fromLandmark[(size_t)source * stride];
+            const float* toS = &toLandmark[(size_t)source * stride];
+            // Insertion into a fixed array, largest bound first; there are only a handful of landmarks
+            pair<float, int> bounds[ACTIVE_LANDMARKS];
+            for (size_t i = 0; i < stride; ++i) {
+                pair<float, int> bound(max(fromT[i] - fromS[i], toS[i] - toT[i]), (int)i);
+                int at = activeCount < ACTIVE_LANDMARKS ? activeCount++ : ACTIVE_LANDMARKS;
+                for (; at > 0 && bounds[at - 1] < bound; --at) {
+                    if (at < ACTIVE_LANDMARKS) bounds[at] = bounds[at - 1];
+                }
+                if (at < ACTIVE_LANDMARKS) bounds[at] = bound;
+            }
+            if (activeCount > 0 && bounds[0].first >= INF / 2) {
+                if (settled) *settled = 0;
+                return INF;
+            }
+            for (int i = 0; i < activeCount; ++i) active[i] = bounds[i].second;
+        }
+
+        auto lowerBound = [&](int v) {
+            const float* fromT = &fromLandmark[(size_t)target * stride];
+            const float* toT = &toLandmark[(size_t)target * stride];
+            const float* fromV = &fromLandmark[(size_t)v * stride];
+            const float* toV = &toLandmark[(size_t)v * stride];
+            float bound = 0;
+            for (int i = 0; i < activeCount; ++i) {
+                int l = active[i];
+                bound = max(bound, max(fromT[l] - fromV[l], toV[l] - toT[l]));
+            }
+            return bound;
+        };
+        if (algorithm == RouteAlgorithm::Landmarks) count = searchTowards(source, target, lowerBound, forward, job);
+        else count = searchTowards(source, target, [](int) { return 0.0f; }, forward, job);
+        dist = forward.dist[target];
+        if (path && dist < INF) {
+            for (int at = target; at != -1; at = forward.prev[at]) {
+                path->push_back(at);
+                if (at == source) break;
+            }
+            reverse(path->begin(), path->end());
+        }
+    }
+
+    if (settled) *settled = count;
+    METRIC_ADD(NodesSettled, count);
+    if (job && job->isCancelled()) return INF;
+    return dist;
+}
@@ -0,0 +1,164 @@
+#ifndef GRAPHCORE_H
+#define GRAPHCORE_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <utility>
+using namespace std;
+
+class JobControl;
+
+// Binary min-heap keyed by node id, with decrease-key through a position table
+class MinHeap {
+public:
+    void reset(int nodeCount);
+    void clear();                       // Empties the queue in O(queued) when the node count is unchanged
+    int capacity() const { return (int)pos.size(); }
+    bool empty() const { return heap.empty(); }
+    bool contains(int node) const { return pos[node] >= 0; }
+    void push(int node, float key);     // Inserts the node, or lowers its key if already queued
+    int pop();                          // Removes and returns the node with the smallest key
+    float topKey() const { return keys[heap[0]]; }
+
+private:
+    vector<int> heap;
+    vector<int> pos;    // pos[node] = slot in heap, -1 when not queued
+    vector<float> keys;
+
+    void siftUp(int slot);
+    void siftDown(int slot);
+};
+
+// Buffers for GraphCore::searchMany and searchWithin, reused across searches. One per thread: several searches
+// can run on the same graph at once as long as each has its own scratch.
+struct SearchScratch {
+    vector<float> dist;         // INF except for reached nodes
+    vector<int> prev;           // -1 except for reached nodes
+    vector<int> touched;        // Nodes reached by the last search, to undo cheaply
+    vector<uint32_t> mark;      // mark[v] == stamp when v is a target still to be settled
+    uint32_t stamp = 0;
+    MinHeap heap;
+
+    // Clears what the last search left behind, resizing for a graph of nodeCount nodes
+    void reset(int nodeCount);
+};
+
+// The calling thread's reusable query buffers. Route queries, batches and radius searches all draw on
+// them, so once they have grown to the graph's size a query allocates nothing. A thread may run one
+// search at a time on its context; searches never nest.
+struct QueryContext {
+    SearchScratch forward;
+    SearchScratch backward;
+    vector<int> path;           // For callers that want a route's cities only long enough to format them
+    vector<int> hops;           // Shortcut-level path before a contraction hierarchy unpacks it
+    vector<pair<int, int>> unpacking;   // Shortcuts still to expand, as (from, to)
+
+    static QueryContext& local();
+};
+
+// Point-to-point search strategies for GraphCore::route
+enum class RouteAlgorithm {
+    Dijkstra,           // Grows a ball around the source until it takes in the target
+    Bidirectional,      // Dijkstra from both ends, stopping once the frontiers prove the best meeting point
+    Landmarks,          // A* with triangle-inequality bounds from precomputed landmarks (ALT)
+    Hierarchy           // Graph's contraction hierarchy when current; GraphCore alone runs Dijkstra
+};
+
+// Compact graph engine: city names are interned to dense ids and edges are kept in CSR arrays
+class GraphCore {
+public:
+    static constexpr float INF = 1e9f;
+    static constexpr int DEFAULT_LANDMARKS = 16;
+
+    int intern(const string& name);             // Returns the id of the city, adding it if needed
+    int findCity(const string& name) const;     // Returns -1 if the city is unknown
+    const string& cityName(int id) const { return names[id]; }
+    int cityCount() const { return (int)names.size(); }
+    bool empty() const { return names.empty(); }
+
+    float addEdge(int from, int to, float distance);   // Directed; returns the replaced weight or INF
+
+    // Replaces the whole graph with one already in CSR form, names distinct and each city's targets
+    // distinct. Returns false (graph unchanged) if the arrays do not fit together.
+    bool assign(vector<string> cityNames, vector<int> offsets, vector<int> targets, vector<float> weights);
+
+    // CSR view, rebuilt lazily after edits
+    const vector<int>& offsets() const { build(); return csrOffsets; }
+    const vector<int>& targets() const { build(); return csrTargets; }
+    const vector<float>& weights() const { build(); return csrWeights; }
+
+    // Shortest path from source to target, returns INF when unreachable. Runs on the thread's QueryContext.
+    float shortestPath(int source, int target, vector<int>* path = nullptr, JobControl* job = nullptr) const;
+
+    // One-to-many search that stops once every target is settled; scratch.dist and scratch.prev then
+    // hold their answers. Safe to run concurrently once the CSR is built (any accessor builds it).
+    void searchMany(int source, const int* targets, size_t count, SearchScratch& scratch) const;
+
+    // Settles every node within limit of source. scratch.touched then lists the nodes reached,
+    // a superset of those within the limit, and scratch.dist their distances.
+    void searchWithin(int source, float limit, SearchScratch& scratch) const;
+
+    // Shortest path from source to target by the chosen search; INF when unreachable. settled, if given,
+    // receives the number of nodes the search settled. Landmarks are built on first use after an edit.
+    // Safe to run concurrently once the CSR (and for Landmarks, the landmark tables) are built.
+    float route(int source, int target, RouteAlgorithm algorithm, vector<int>* path = nullptr,
+                int* settled = nullptr, JobControl* job = nullptr) const;
+
+    // Picks count landmarks, each the city farthest from those already picked, and records every
+    // city's distance from and to each one. Call after a batch of edits to keep the cost out of the
+    // first Landmarks query. Returns false if job was cancelled, leaving the landmarks unbuilt.
+    bool buildLandmarks(int count = DEFAULT_LANDMARKS, JobControl* job = nullptr) const;
+    bool hasLandmarks() const { return !landmarksStale; }
+
+    // Changes with every edit, so derived structures can tell whether they still match
+    uint64_t revision() const { return edits; }
+
+private:
+    vector<string> names;
+    vector<int> nameSlots;  // Open-addressing index into names, -1 when empty; a power of two, at most half full
+    bool staged = true;                         // False after assign() until the first edit copies the CSR back
+
+    // Staging adjacency, the source of truth for edits. A monotonic arena: each city's edges fill a chain
+    // of fixed-size blocks carved from one pool, which only grows until the graph is replaced, so adding
+    // roads costs an occasional pool regrowth rather than allocations per city.
+    struct EdgeBlock {
+        static const int CAPACITY = 6;
+        int next = -1;          // Next block of the same city, -1 for its last
+        int count = 0;
+        int targets[CAPACITY];
+        float weights[CAPACITY];
+    };
+    vector<EdgeBlock> edgeBlocks;
+    vector<int> firstBlock;     // Per city, -1 while it has no edges
+    vector<int> lastBlock;
+    uint64_t edits = 0;
+
+    mutable bool dirty = false;
+    mutable vector<int> csrOffsets{0};
+    mutable vector<int> csrTargets;
+    mutable vector<float> csrWeights;
+    mutable vector<int> reverseOffsets{0};      // Incoming edges in the same layout, for backward searches
+    mutable vector<int> reverseTargets;
+    mutable vector<float> reverseWeights;
+
+    mutable bool landmarksStale = true;         // Any edit invalidates the bounds
+    mutable vector<int> landmarks;
+    mutable vector<float> fromLandmark;         // [v * landmarks.size() + i] = distance from landmark i to v
+    mutable vector<float> toLandmark;           // Same layout, distance from v to landmark i
+
+    void rehash(size_t slotCount);
+    void stage();
+    void appendEdge(int from, int to, float distance);
+    void build() const;
+    void buildReverse() const;
+    void distancesFrom(int source, bool backward, vector<float>& dist) const;
+
+    // A* from source until target is settled; a zero potential makes it Dijkstra. Returns nodes settled.
+    template <typename Potential>
+    int searchTowards(int source, int target, Potential potential, SearchScratch& scratch, JobControl* job) const;
+    int searchBidirectional(int source, int target, SearchScratch& forward, SearchScratch& backward, int& meet,
+                            float& best, JobControl* job) const;
+};
+
+#endif // GRAPHCORE_H
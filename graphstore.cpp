@@ -0,0 +1,385 @@
+#include "graphstore.h"
+#include "asyncjob.h"
+#include "hotellog.h"
+#include "hotelstore.h"
+#include "metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Each pool thread parses several chunks, so uneven lines still spread evenly
+const int CHUNKS_PER_THREAD = 4;
+const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+struct Road {
+    int from, to;
+    float km;
+};
+
+// Names to dense ids in order of first appearance, hashed with open addressing
+class NameTable {
+public:
+    vector<string> names;
+
+    int add(const string& name)
+    {
+        size_t slot = slotOf(name);
+        if (nameSlots[slot] >= 0) return nameSlots[slot];
+        nameSlots[slot] = names.size();
+        names.push_back(name);
+        if (names.size() * 2 > nameSlots.size()) {
+            nameSlots.assign(nameSlots.size() * 2, -1);
+            for (size_t id = 0; id < names.size(); ++id) nameSlots[slotOf(names[id])] = id;
+        }
+        return names.size() - 1;
+    }
+
+private:
+    vector<int> nameSlots = vector<int>(1024, -1);
+
+    size_t slotOf(const string& name) const
+    {
+        size_t mask = nameSlots.size() - 1;
+        size_t slot = hash<string>()(name) & mask;
+        while (nameSlots[slot] >= 0 && names[nameSlots[slot]] != name) slot = (slot + 1) & mask;
+        return slot;
+    }
+};
+
+// One slice of the file, split at line starts, and what it parsed into. City ids are local to the
+// chunk and follow first appearance, so merging the chunks in order numbers cities by first appearance.
+struct Chunk {
+    const char* begin;
+    const char* end;
+    NameTable cities;
+    vector<Road> roads;
+    size_t lines = 0;
+    size_t errorLine = 0;       // Within the chunk, from 1; 0 when the chunk parsed
+    string error;
+};
+
+bool isBlank(char c, char separator) { return (c == ' ' || c == '\t') && c != separator; }
+
+// Reads one field up to the separator or the end of the line, leaving at on whichever ended it.
+// Quoted fields keep their separators and write a quote as two.
+bool readField(const char*& at, const char* end, char separator, string& field)
+{
+    field.clear();
+    while (at < end && isBlank(*at, separator)) ++at;
+    if (at < end && *at == '"') {
+        for (++at;; ++at) {
+            if (at == end) return false;
+            if (*at == '"') {
+                if (at + 1 == end || at[1] != '"') break;
+                ++at;
+            }
+            field += *at;
+        }
+        ++at;
+        while (at < end && isBlank(*at, separator)) ++at;
+        return at == end || *at == separator;
+    }
+    const char* start = at;
+    while (at < end && *at != separator) ++at;
+    const char* last = at;
+    while (last > start && isBlank(last[-1], separator)) --last;
+    field.assign(start, last);
+    return true;
+}
+
+// First three fields of a line; tab-separated when the line has a tab, else comma-separated
+bool splitLine(const char* at, const char* end, string (&fields)[3])
+{
+    char separator = memchr(at, '\t', end - at) ? '\t' : ',';
+    for (int i = 0; i < 3; ++i) {
+        if (i > 0) {
+            if (at == end) return false;
+            ++at;
+        }
+        if (!readField(at, end, separator, fields[i])) return false;
+    }
+    return true;
+}
+
+bool parseNumber(const string& text, float& value)
+{
+    const char* first = text.data() + (!text.empty() && text[0] == '+');
+    const char* last = text.data() + text.size();
+    auto [ptr, ec] = from_chars(first, last, value);
+    return first != last && ec == errc() && ptr == last;
+}
+
+void parseChunk(Chunk& chunk, bool first)
+{
+    auto idOf = [&](string& name) {
+        transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)tolower(c); });
+        return chunk.cities.add(name);
+    };
+
+    string fields[3];
+    bool headerAllowed = first;
+    for (const char* at = chunk.begin; at < chunk.end;) {
+        const char* lineEnd = (const char*)memchr(at, '\n', chunk.end - at);
+        if (!lineEnd) lineEnd = chunk.end;
+        const char* line = at;
+        at = lineEnd < chunk.end ? lineEnd + 1 : chunk.end;
+        ++chunk.lines;
+
+        if (lineEnd > line && lineEnd[-1] == '\r') --lineEnd;
+        const char* text = line;
+        while (text < lineEnd && (*text == ' ' || *text == '\t')) ++text;
+        if (text == lineEnd || *text == '#') continue;
+
+        float km = 0;
+        bool split = splitLine(line, lineEnd, fields);
+        bool numeric = split && parseNumber(fields[2], km);
+        if (headerAllowed) {
+            headerAllowed = false;
+            if (split && !numeric) continue;
+        }
+        bool valid = numeric && isfinite(km) && km >= 0;
+        if (!valid || fields[0].empty() || fields[1].empty()) {
+            chunk.errorLine = chunk.lines;
+            chunk.error = !split ? "expected FROM,TO,KM"
+                        : !valid ? "bad distance: " + fields[2]
+                        : "empty city name";
+            return;
+        }
+        int from = idOf(fields[0]);
+        chunk.roads.push_back({from, idOf(fields[1]), km});
+    }
+}
+
+// On-disk layout (little-endian): header | nameOffsets uint64[n + 1] | offsets int32[n + 1]
+//   | targets int32[m] | weights float[m] | name heap
+struct FileHeader {
+    char magic[8];              // "SMTGRAPH"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t cities;
+    uint64_t edges;
+    uint64_t namesSize;
+};
+
+const uint32_t FILE_VERSION = 1;
+
+} // namespace
+
+bool importEdgeList(const string& path, GraphCore& graph, string& error, ThreadPool* pool, JobControl* job)
+{
+    METRIC_TIMER(GraphImport);
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "unable to open " + path;
+        return false;
+    }
+
+    // Split at line starts; each chunk parses on its own
+    size_t chunkCount = pool ? (size_t)pool->size() * CHUNKS_PER_THREAD : 1;
+    chunkCount = max<size_t>(1, min(chunkCount, file.size() / MIN_CHUNK_BYTES));
+    vector<Chunk> chunks(chunkCount);
+    const char* data = file.data();
+    const char* end = data + file.size();
+    const char* begin = data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* stop = i + 1 == chunkCount ? end : max(begin, data + file.size() / chunkCount * (i + 1));
+        if (stop < end) {
+            const char* newline = (const char*)memchr(stop, '\n', end - stop);
+            stop = newline ? newline + 1 : end;
+        }
+        chunks[i].begin = begin;
+        chunks[i].end = stop;
+        begin = stop;
+    }
+
+    atomic<size_t> parsed{0};
+    auto parse = [&](int i) {
+        if (job && job->isCancelled()) return;
+        parseChunk(chunks[i], i == 0);
+        if (job) job->progress(++parsed, chunkCount + 1);
+    };
+    if (pool) pool->parallelFor(chunkCount, parse);
+    else for (size_t i = 0; i < chunkCount; ++i) parse(i);
+    if (job && job->isCancelled()) return false;
+
+    size_t lineBase = 0;
+    for (const Chunk& chunk : chunks) {
+        if (chunk.errorLine) {
+            error = path + " line " + to_string(lineBase + chunk.errorLine) + ": " + chunk.error;
+            return false;
+        }
+        lineBase += chunk.lines;
+    }
+
+    // Cities already in graph keep their ids; new ones follow in order of first appearance
+    int oldCount = graph.cityCount();
+    NameTable added;
+    size_t roadCount = 0;
+    for (Chunk& chunk : chunks) {
+        const vector<string>& local = chunk.cities.names;
+        vector<int> global(local.size());
+        for (size_t i = 0; i < local.size(); ++i) {
+            int id = graph.findCity(local[i]);
+            global[i] = id >= 0 ? id : oldCount + added.add(local[i]);
+        }
+        chunk.cities = NameTable();
+        for (Road& road : chunk.roads) {
+            road.from = global[road.from];
+            road.to = global[road.to];
+        }
+        roadCount += chunk.roads.size();
+    }
+
+    // Existing edges, then both directions of every road in file order
+    vector<string> names;
+    names.reserve(oldCount + added.names.size());
+    for (int id = 0; id < oldCount; ++id) names.push_back(graph.cityName(id));
+    for (string& name : added.names) names.push_back(move(name));
+    int n = names.size();
+    const vector<int>& oldOffsets = graph.offsets();
+    const vector<int>& oldTargets = graph.targets();
+    const vector<float>& oldWeights = graph.weights();
+    if (oldTargets.size() + 2 * roadCount > (size_t)INT_MAX) {
+        error = path + ": too many roads";
+        return false;
+    }
+    vector<int> offsets(n + 1, 0);
+    for (int u = 0; u < oldCount; ++u) offsets[u + 1] = oldOffsets[u + 1] - oldOffsets[u];
+    for (const Chunk& chunk : chunks) {
+        for (const Road& road : chunk.roads) {
+            offsets[road.from + 1]++;
+            offsets[road.to + 1]++;
+        }
+    }
+    for (int u = 0; u < n; ++u) offsets[u + 1] += offsets[u];
+
+    vector<int> targets(offsets[n]);
+    vector<float> weights(offsets[n]);
+    vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < oldCount; ++u) {
+        for (int k = oldOffsets[u]; k < oldOffsets[u + 1]; ++k) {
+            targets[next[u]] = oldTargets[k];
+            weights[next[u]++] = oldWeights[k];
+        }
+    }
+    for (const Chunk& chunk : chunks) {
+        for (const Road& road : chunk.roads) {
+            targets[next[road.from]] = road.to;
+            weights[next[road.from]++] = road.km;
+            targets[next[road.to]] = road.from;
+            weights[next[road.to]++] = road.km;
+        }
+    }
+    chunks.clear();
+
+    // Collapse repeated targets city by city, as addEdge would have, then close the gaps
+    vector<int> kept(n);
+    int blocks = pool ? max<int>(1, min<int>(pool->size(), n)) : 1;
+    auto collapse = [&](int block) {
+        vector<int> slot(n, -1);
+        for (int u = (long long)n * block / blocks; u < (long long)n * (block + 1) / blocks; ++u) {
+            int write = offsets[u];
+            for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+                int v = targets[k];
+                if (slot[v] >= 0) {
+                    weights[slot[v]] = weights[k];
+                    continue;
+                }
+                slot[v] = write;
+                targets[write] = v;
+                weights[write++] = weights[k];
+            }
+            kept[u] = write - offsets[u];
+            for (int k = offsets[u]; k < write; ++k) slot[targets[k]] = -1;
+        }
+    };
+    if (pool) pool->parallelFor(blocks, collapse);
+    else collapse(0);
+    if (job && job->isCancelled()) return false;
+
+    int write = 0;
+    for (int u = 0; u < n; ++u) {
+        int read = offsets[u];
+        offsets[u] = write;
+        for (int k = 0; k < kept[u]; ++k, ++write) {
+            targets[write] = targets[read + k];
+            weights[write] = weights[read + k];
+        }
+    }
+    offsets[n] = write;
+    targets.resize(write);
+    weights.resize(write);
+
+    graph.assign(move(names), move(offsets), move(targets), move(weights));
+    if (job) job->progress(1, 1);
+    return true;
+}
+
+bool saveGraph(const GraphCore& graph, const string& path)
+{
+    METRIC_TIMER(GraphSave);
+    size_t n = graph.cityCount();
+    vector<uint64_t> nameOffsets(n + 1, 0);
+    for (size_t id = 0; id < n; ++id) nameOffsets[id + 1] = nameOffsets[id] + graph.cityName(id).size();
+
+    FileHeader header{};
+    memcpy(header.magic, "SMTGRAPH", 8);
+    header.version = FILE_VERSION;
+    header.cities = n;
+    header.edges = graph.targets().size();
+    header.namesSize = nameOffsets[n];
+
+    string data;
+    data.reserve(sizeof(header) + (n + 1) * (sizeof(uint64_t) + sizeof(int32_t))
+                 + header.edges * (sizeof(int32_t) + sizeof(float)) + header.namesSize);
+    auto put = [&](const void* bytes, size_t size) { data.append((const char*)bytes, size); };
+    put(&header, sizeof(header));
+    put(nameOffsets.data(), nameOffsets.size() * sizeof(uint64_t));
+    put(graph.offsets().data(), graph.offsets().size() * sizeof(int32_t));
+    put(graph.targets().data(), graph.targets().size() * sizeof(int32_t));
+    put(graph.weights().data(), graph.weights().size() * sizeof(float));
+    for (size_t id = 0; id < n; ++id) data += graph.cityName(id);
+    return replaceFileSynced(path, data);
+}
+
+bool loadGraph(const string& path, GraphCore& graph)
+{
+    METRIC_TIMER(GraphLoad);
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+    FileHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, "SMTGRAPH", 8) != 0 || header.version != FILE_VERSION) return false;
+    if (header.cities >= (uint64_t)INT_MAX || header.edges > (uint64_t)INT_MAX) return false;
+
+    size_t n = header.cities, m = header.edges;
+    size_t expected = sizeof(FileHeader) + (n + 1) * (sizeof(uint64_t) + sizeof(int32_t))
+                      + m * (sizeof(int32_t) + sizeof(float)) + header.namesSize;
+    if (file.size() != expected) return false;
+
+    const char* at = file.data() + sizeof(FileHeader);
+    auto take = [&](auto& column, size_t count) {
+        column.resize(count);
+        memcpy(column.data(), at, count * sizeof(column[0]));
+        at += count * sizeof(column[0]);
+    };
+    vector<uint64_t> nameOffsets;
+    vector<int> offsets, targets;
+    vector<float> weights;
+    take(nameOffsets, n + 1);
+    take(offsets, n + 1);
+    take(targets, m);
+    take(weights, m);
+
+    vector<string> names(n);
+    if (nameOffsets[0] != 0 || nameOffsets[n] != header.namesSize) return false;
+    for (size_t id = 0; id < n; ++id) {
+        if (nameOffsets[id] > nameOffsets[id + 1]) return false;
+        names[id].assign(at + nameOffsets[id], nameOffsets[id + 1] - nameOffsets[id]);
+    }
+    return graph.assign(move(names), move(offsets), move(targets), move(weights));
+}
@@ -0,0 +1,26 @@
+#ifndef GRAPHSTORE_H
+#define GRAPHSTORE_H
+
+#include <string>
+#include "graphcore.h"
+#include "threadpool.h"
+using namespace std;
+
+class JobControl;
+
+// Adds every road of a text edge list to graph, each in both directions like Graph::addPath.
+// One road per line, FROM,TO,KM or the same separated by tabs. Fields may be double-quoted and
+// extra columns are ignored; blank lines and lines starting with # are skipped, and a first line
+// whose distance is not a number is a header. City names are lowercased. A road listed again keeps
+// its first position and its last distance. The file is mapped and parsed in chunks across the
+// pool, then the CSR is built in one pass. On failure graph is unchanged and error names the line.
+bool importEdgeList(const string& path, GraphCore& graph, string& error,
+                    ThreadPool* pool = &ThreadPool::shared(), JobControl* job = nullptr);
+
+// Binary snapshot of the city names and CSR arrays, written through a synced temporary file
+bool saveGraph(const GraphCore& graph, const string& path);
+
+// Replaces graph with a saved snapshot; false (graph unchanged) if missing, damaged or of another version
+bool loadGraph(const string& path, GraphCore& graph);
+
+#endif // GRAPHSTORE_H
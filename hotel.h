@@ -0,0 +1,68 @@
+#ifndef HOTEL_H
+#define HOTEL_H
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+using namespace std;
+
+class Hotel{
+private:
+    int id;
+    string name;
+    int price;
+    float rating;
+    float distance;             // From the centre of city, km
+    float latitude = NAN;       // Degrees, NaN when unknown
+    float longitude = NAN;
+    string city;                // Graph city the hotel belongs to (lowercase), empty if none
+
+public:
+    Hotel()=default;
+    Hotel(int i, string n, int p, float r, float d)
+        : id(i), name(n), price(p), rating(r), distance(d) {}
+
+    int getId() const { return id; }
+    string getName() const { return name; }
+    int getPrice() const { return price; }
+    float getRating() const { return rating; }
+    float getDistance() const { return distance; }
+    float getLatitude() const { return latitude; }
+    float getLongitude() const { return longitude; }
+    bool hasCoordinates() const { return !isnan(latitude) && !isnan(longitude); }
+    string getCity() const { return city; }
+
+    void setId(int i) { id = i; }
+    void setName(const string& n) { name = n; }
+    void setPrice(int p) { price = p; }
+    void setRating(float r) { rating = r; }
+    void setDistance(float d) { distance = d; }
+    void setCoordinates(float lat, float lon) { latitude = lat; longitude = lon; }
+    void setCity(const string& c) { city = c; }
+
+    void printDetail()const
+    {
+        string ID = "H" + to_string(id);
+        cout<<ID<<" "<<name<<endl;
+        cout<<"Price: "<<price<<endl;
+        cout<<"Rating: "<<rating<<endl;
+        cout<<"Distance: "<<distance<<endl;
+        if (!city.empty()) cout<<"City: "<<city<<endl;
+        if (hasCoordinates()) cout<<"Location: "<<latitude<<", "<<longitude<<endl;
+    }
+
+    string getDetailString() const
+    {
+        ostringstream out;
+        out << "H" << id << " " << name << "\n"
+            << "Price: $" << price << "\n"
+            << "Rating: " << rating << "\n"
+            << "Distance: " << distance << " km";
+        if (!city.empty()) out << "\nCity: " << city;
+        if (hasCoordinates()) out << "\nLocation: " << latitude << ", " << longitude;
+        return out.str();
+    }
+};
+
+#endif // HOTEL_H
@@ -0,0 +1,239 @@
+#include "hotelindex.h"
+#include "metrics.h"
+#include <algorithm>
+
+bool SortedIndex::before(const HotelTable& table, uint32_t a, uint32_t b) const
+{
+    switch (key) {
+    case Price:
+        if (table.price(a) != table.price(b)) return table.price(a) < table.price(b);
+        break;
+    case Rating:
+        if (table.rating(a) != table.rating(b)) return table.rating(a) > table.rating(b);
+        break;
+    case Distance:
+        if (table.distance(a) != table.distance(b)) return table.distance(a) < table.distance(b);
+        break;
+    case Name:
+        if (table.nameId(a) != table.nameId(b)) {
+            int order = table.name(a).compare(table.name(b));
+            if (order != 0) return order < 0;
+        }
+        break;
+    case NameId:
+        if (a != b) return table.names().name(a) < table.names().name(b);
+        break;
+    }
+    return a < b;
+}
+
+float SortedIndex::value(const HotelTable& table, uint32_t row) const
+{
+    switch (key) {
+    case Price: return table.price(row);
+    case Rating: return table.rating(row);
+    default: return table.distance(row);
+    }
+}
+
+IndexSpan::Iterator& IndexSpan::Iterator::operator++()
+{
+    ++position;
+    if (++at == blockEnd && position < last) {
+        ++block;
+        at = (*block)->data();
+        blockEnd = at + (*block)->size();
+    }
+    return *this;
+}
+
+IndexSpan::Iterator IndexSpan::begin() const
+{
+    Iterator it;
+    it.position = first;
+    it.last = last;
+    if (first == last) return it;
+    size_t b = index->blockOf(first);
+    it.block = &index->blocks[b];
+    it.at = index->blocks[b]->data() + (first - index->blockStart(b));
+    it.blockEnd = index->blocks[b]->data() + index->blocks[b]->size();
+    return it;
+}
+
+IndexSpan::Iterator IndexSpan::end() const
+{
+    Iterator it;
+    it.position = last;
+    it.last = last;
+    return it;
+}
+
+uint32_t IndexSpan::operator[](size_t i) const
+{
+    size_t b = index->blockOf(first + i);
+    return (*index->blocks[b])[first + i - index->blockStart(b)];
+}
+
+size_t SortedIndex::blockOf(size_t position) const
+{
+    size_t b = upper_bound(ends.begin(), ends.end(), position) - ends.begin();
+    return min(b, blocks.size() - 1);
+}
+
+SortedIndex::Block& SortedIndex::writable(size_t b)
+{
+    // Published copies only read their blocks (see ChunkedColumn)
+    if (blocks[b].use_count() > 1) blocks[b] = make_shared<Block>(*blocks[b]);
+    return *blocks[b];
+}
+
+template <typename Pred>
+size_t SortedIndex::partitionPoint(Pred pred) const
+{
+    // The first block whose last row fails holds the answer
+    auto block = partition_point(blocks.begin(), blocks.end(), [&](const shared_ptr<Block>& b) { return pred(b->back()); });
+    if (block == blocks.end()) return size();
+    size_t b = block - blocks.begin();
+    return blockStart(b) + (partition_point((*block)->begin(), (*block)->end(), pred) - (*block)->begin());
+}
+
+void SortedIndex::rebuild(const HotelTable& table)
+{
+    Block rows;
+    if (key == NameId) {
+        vector<bool> seen(table.names().size());
+        for (uint32_t i = 0; i < table.size(); ++i) {
+            if (table.isLive(i) && !seen[table.nameId(i)]) {
+                seen[table.nameId(i)] = true;
+                rows.push_back(table.nameId(i));
+            }
+        }
+    } else {
+        rows.reserve(table.liveCount());
+        for (uint32_t i = 0; i < table.size(); ++i) {
+            if (table.isLive(i)) rows.push_back(i);
+        }
+    }
+    if (key == Name || key == NameId) {
+        sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) { return before(table, a, b); });
+    } else {
+        // Sorting (key, row) pairs keeps the chunked column lookups out of the comparisons
+        vector<pair<double, uint32_t>> keyed;
+        keyed.reserve(rows.size());
+        for (uint32_t row : rows) {
+            double order = key == Price ? table.price(row) : key == Rating ? -table.rating(row) : table.distance(row);
+            keyed.push_back({order, row});
+        }
+        sort(keyed.begin(), keyed.end());
+        for (size_t i = 0; i < rows.size(); ++i) rows[i] = keyed[i].second;
+    }
+
+    blocks.clear();
+    ends.clear();
+    for (size_t from = 0; from < rows.size(); from += BLOCK) {
+        size_t to = min(rows.size(), from + BLOCK);
+        blocks.push_back(make_shared<Block>(rows.begin() + from, rows.begin() + to));
+        ends.push_back(to);
+    }
+}
+
+void SortedIndex::insert(const HotelTable& table, uint32_t row)
+{
+    size_t position = partitionPoint([&](uint32_t r) { return !before(table, row, r); });
+    if (blocks.empty()) {
+        blocks.push_back(make_shared<Block>(1, row));
+        ends.push_back(1);
+        return;
+    }
+
+    size_t b = blockOf(position);
+    Block& block = writable(b);
+    block.insert(block.begin() + (position - blockStart(b)), row);
+    for (size_t i = b; i < ends.size(); ++i) ends[i]++;
+
+    if (block.size() > 2 * BLOCK) {
+        auto upper = make_shared<Block>(block.begin() + BLOCK, block.end());
+        block.resize(BLOCK);
+        blocks.insert(blocks.begin() + b + 1, move(upper));
+        ends.insert(ends.begin() + b, blockStart(b) + BLOCK);
+    }
+}
+
+void SortedIndex::erase(const HotelTable& table, uint32_t row)
+{
+    // Ties are broken by row, so the lower bound is the row itself
+    size_t position = partitionPoint([&](uint32_t r) { return before(table, r, row); });
+    if (position == size()) return;
+    size_t b = blockOf(position);
+    size_t offset = position - blockStart(b);
+    if ((*blocks[b])[offset] != row) return;
+
+    Block& block = writable(b);
+    block.erase(block.begin() + offset);
+    for (size_t i = b; i < ends.size(); ++i) ends[i]--;
+
+    // Empty blocks go, and small ones fold into the next
+    if (block.empty()) {
+        blocks.erase(blocks.begin() + b);
+        ends.erase(ends.begin() + b);
+    } else if (block.size() < BLOCK / 4 && b + 1 < blocks.size() && block.size() + blocks[b + 1]->size() <= 2 * BLOCK) {
+        block.insert(block.end(), blocks[b + 1]->begin(), blocks[b + 1]->end());
+        blocks.erase(blocks.begin() + b + 1);
+        ends.erase(ends.begin() + b);
+    }
+}
+
+IndexSpan SortedIndex::range(const HotelTable& table, float low, float high) const
+{
+    // Rating descends, so its bounds swap roles
+    size_t first, last;
+    if (key == Rating) {
+        first = partitionPoint([&](uint32_t r) { return value(table, r) > high; });
+        last = partitionPoint([&](uint32_t r) { return value(table, r) >= low; });
+    } else {
+        first = partitionPoint([&](uint32_t r) { return value(table, r) < low; });
+        last = partitionPoint([&](uint32_t r) { return value(table, r) <= high; });
+    }
+    return {this, first, max(first, last)};
+}
+
+IndexSpan SortedIndex::equalRange(const HotelTable& table, string_view name) const
+{
+    size_t first = partitionPoint([&](uint32_t r) { return table.name(r) < name; });
+    size_t last = partitionPoint([&](uint32_t r) { return table.name(r) <= name; });
+    return {this, first, last};
+}
+
+IndexSpan SortedIndex::startingWith(const HotelTable& table, string_view text) const
+{
+    // Names below text come first, then the ones starting with it
+    auto below = [&](uint32_t id) { return string_view(table.names().name(id)) < text; };
+    size_t first = partitionPoint(below);
+    size_t last = partitionPoint([&](uint32_t id) { return below(id) || table.names().name(id).compare(0, text.size(), text) == 0; });
+    return {this, first, last};
+}
+
+void HotelIndexes::rebuild(const HotelTable& table)
+{
+    METRIC_TIMER(IndexRebuild);
+    byPrice.rebuild(table);
+    byRating.rebuild(table);
+    byDistance.rebuild(table);
+    byName.rebuild(table);
+}
+
+void HotelIndexes::insert(const HotelTable& table, uint32_t row)
+{
+    byPrice.insert(table, row);
+    byRating.insert(table, row);
+    byDistance.insert(table, row);
+    byName.insert(table, row);
+}
+
+void HotelIndexes::erase(const HotelTable& table, uint32_t row)
+{
+    byPrice.erase(table, row);
+    byRating.erase(table, row);
+    byDistance.erase(table, row);
+    byName.erase(table, row);
+}
@@ -0,0 +1,128 @@
+#ifndef HOTELINDEX_H
+#define HOTELINDEX_H
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "hoteltable.h"
+using namespace std;
+
+// Contiguous run of row numbers inside an index, valid until the index changes
+struct RowSpan {
+    const uint32_t* first = nullptr;
+    const uint32_t* last = nullptr;
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    uint32_t operator[](size_t i) const { return first[i]; }
+};
+
+class SortedIndex;
+
+// Stretch of a SortedIndex in order, valid until the index changes. The rows sit in blocks, so
+// iteration is the way through; indexing searches for the block.
+class IndexSpan {
+public:
+    class Iterator {
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef uint32_t value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const uint32_t* pointer;
+        typedef const uint32_t& reference;
+
+        const uint32_t& operator*() const { return *at; }
+        Iterator& operator++();
+        bool operator==(const Iterator& other) const { return position == other.position; }
+        bool operator!=(const Iterator& other) const { return position != other.position; }
+
+    private:
+        friend class IndexSpan;
+        const shared_ptr<vector<uint32_t>>* block = nullptr;
+        const uint32_t* at = nullptr;
+        const uint32_t* blockEnd = nullptr;
+        size_t position = 0;
+        size_t last = 0;
+    };
+
+    IndexSpan() = default;
+    IndexSpan(const SortedIndex* index, size_t first, size_t last) : index(index), first(first), last(last) {}
+
+    Iterator begin() const;
+    Iterator end() const;
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    uint32_t operator[](size_t i) const;
+    IndexSpan slice(size_t from, size_t to) const { return {index, first + from, first + to}; }
+
+private:
+    const SortedIndex* index = nullptr;
+    size_t first = 0;
+    size_t last = 0;
+};
+
+// Permutation of HotelTable rows kept sorted by one attribute; ties keep row order.
+// Price, distance and name ascend, rating descends, matching the sorted views. NameId instead
+// holds the distinct NamePool ids of live rows in name order.
+// The order is cut into blocks of up to 2 * BLOCK rows that copies share, so a copy costs one
+// pointer per block and an insert or erase copies (and shifts) only the block it lands in.
+class SortedIndex {
+public:
+    enum Key { Price, Rating, Distance, Name, NameId };
+    static constexpr size_t BLOCK = 1024;
+
+    explicit SortedIndex(Key key) : key(key) {}
+
+    void rebuild(const HotelTable& table);
+    void insert(const HotelTable& table, uint32_t row);    // O(log n) search plus a shift within one block
+    void erase(const HotelTable& table, uint32_t row);     // Call while the row still holds its indexed key
+
+    size_t size() const { return ends.empty() ? 0 : ends.back(); }
+    IndexSpan all() const { return {this, 0, size()}; }
+
+    // Rows whose numeric key lies in [low, high] (Price, Rating, Distance)
+    IndexSpan range(const HotelTable& table, float low, float high) const;
+
+    // Rows with exactly this name (Name)
+    IndexSpan equalRange(const HotelTable& table, string_view name) const;
+
+    // Name ids whose name starts with text (NameId)
+    IndexSpan startingWith(const HotelTable& table, string_view text) const;
+
+private:
+    friend class IndexSpan;
+    typedef vector<uint32_t> Block;
+
+    Key key;
+    vector<shared_ptr<Block>> blocks;   // Never empty ones
+    vector<size_t> ends;                // Position just past each block
+
+    bool before(const HotelTable& table, uint32_t a, uint32_t b) const;
+    float value(const HotelTable& table, uint32_t row) const;
+
+    size_t blockOf(size_t position) const;          // Block holding position, or the last one at size()
+    size_t blockStart(size_t b) const { return b ? ends[b - 1] : 0; }
+    Block& writable(size_t b);
+
+    // First position whose row fails pred, which must hold for a prefix of the order
+    template <typename Pred>
+    size_t partitionPoint(Pred pred) const;
+};
+
+// The secondary indexes HotelManager maintains over its table
+struct HotelIndexes {
+    SortedIndex byPrice{SortedIndex::Price};
+    SortedIndex byRating{SortedIndex::Rating};
+    SortedIndex byDistance{SortedIndex::Distance};
+    SortedIndex byName{SortedIndex::Name};
+
+    void rebuild(const HotelTable& table);
+    void insert(const HotelTable& table, uint32_t row);
+    void erase(const HotelTable& table, uint32_t row);
+};
+
+#endif // HOTELINDEX_H
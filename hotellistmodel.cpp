@@ -0,0 +1,149 @@
+#include "hotellistmodel.h"
+#include <algorithm>
+
+// Rows handed to the view per fetchMore
+static const int FETCH_BATCH = 500;
+
+HotelListModel::HotelListModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+void HotelListModel::setSnapshot(HotelSnapshotPtr next)
+{
+    snapshot = move(next);
+    rebuild();
+}
+
+void HotelListModel::setFilter(const HotelFilter& next)
+{
+    filter = next;
+    rebuild();
+}
+
+void HotelListModel::setSkylineOnly(bool only)
+{
+    skylineOnly = only;
+    rebuild();
+}
+
+void HotelListModel::sort(int column, Qt::SortOrder order)
+{
+    if (column == sortColumn && order == sortOrder && !rows.empty()) return;
+    sortColumn = column;
+    sortOrder = order;
+    rebuild();
+}
+
+void HotelListModel::rebuild()
+{
+    beginResetModel();
+    rows.clear();
+    fetched = 0;
+    if (snapshot) {
+        const HotelTable& table = snapshot->hotels();
+        bool descending = sortOrder == Qt::DescendingOrder;
+        auto keep = [&](uint32_t row) {
+            return filter.matches(table.price(row), table.rating(row), table.distance(row));
+        };
+
+        // The sorted indexes already hold every live row in order; rating's runs high to low
+        IndexSpan indexed;
+        bool reversed = descending;
+        if (sortColumn == Price) indexed = snapshot->sortedByPrice();
+        else if (sortColumn == Distance) indexed = snapshot->sortedByDistance();
+        else if (sortColumn == Name) indexed = snapshot->byName->all();
+        else if (sortColumn == Rating) {
+            indexed = snapshot->sortedByRating();
+            reversed = !descending;
+        }
+
+        if (skylineOnly) {
+            // The front is small next to the table, so it is sorted directly
+            rows = snapshot->skyline(filter);
+            if (sortColumn == Name || sortColumn == City) {
+                stable_sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) {
+                    string_view x = sortColumn == Name ? table.name(a) : table.city(a);
+                    string_view y = sortColumn == Name ? table.name(b) : table.city(b);
+                    return descending ? y < x : x < y;
+                });
+            } else {
+                SortKey::Attribute key = sortColumn == Price ? SortKey::Price
+                                       : sortColumn == Rating ? SortKey::Rating
+                                       : sortColumn == Distance ? SortKey::Distance : SortKey::Id;
+                std::sort(rows.begin(), rows.end(), RowOrder(table, {{key, descending}}));
+            }
+        } else if (sortColumn == Id || sortColumn == City) {
+            filterHotels(table, filter, rows);
+            if (sortColumn == Id) {
+                std::sort(rows.begin(), rows.end(), RowOrder(table, {{SortKey::Id, descending}}));
+            } else {
+                stable_sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) {
+                    return descending ? table.city(b) < table.city(a) : table.city(a) < table.city(b);
+                });
+            }
+        } else {
+            for (uint32_t row : indexed) {
+                if (keep(row)) rows.push_back(row);
+            }
+            if (reversed) reverse(rows.begin(), rows.end());
+        }
+        fetched = min<size_t>(rows.size(), FETCH_BATCH);
+    }
+    endResetModel();
+}
+
+int HotelListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : fetched;
+}
+
+int HotelListModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+bool HotelListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && (size_t)fetched < rows.size();
+}
+
+void HotelListModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid()) return;
+    int more = min<size_t>(rows.size() - fetched, FETCH_BATCH);
+    if (more <= 0) return;
+    beginInsertRows(QModelIndex(), fetched, fetched + more - 1);
+    fetched += more;
+    endInsertRows();
+}
+
+QVariant HotelListModel::data(const QModelIndex& index, int role) const
+{
+    if (!snapshot || !index.isValid() || index.row() >= fetched) return QVariant();
+
+    if (role == Qt::TextAlignmentRole) {
+        bool numeric = index.column() != Name && index.column() != City;
+        return int((numeric ? Qt::AlignRight : Qt::AlignLeft) | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) return QVariant();
+
+    const HotelTable& table = snapshot->hotels();
+    uint32_t row = rows[index.row()];
+    switch (index.column()) {
+    case Id: return QString("H%1").arg(table.id(row));
+    case Name: return QString::fromStdString(table.name(row));
+    case Price: return QString("$%1").arg(table.price(row));
+    case Rating: return QString::number(table.rating(row));
+    case Distance: return QString::number(table.distance(row)) + " km";
+    case City: {
+        string_view city = table.city(row);
+        return QString::fromUtf8(city.data(), city.size());
+    }
+    }
+    return QVariant();
+}
+
+QVariant HotelListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) return QVariant();
+    static const char* const TITLES[ColumnCount] = {"ID", "Name", "Price", "Rating", "Distance", "City"};
+    return section >= 0 && section < ColumnCount ? QString(TITLES[section]) : QVariant();
+}
@@ -0,0 +1,45 @@
+#ifndef HOTELLISTMODEL_H
+#define HOTELLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <vector>
+#include "management.h"
+
+// Hotels of one snapshot as a table. The model keeps only a permutation of table rows: sorting walks
+// the snapshot's sorted indexes (or sorts row numbers), filtering drops entries, and no hotel is
+// formatted until the view asks for one of its cells. Rows reach the view in batches as it scrolls.
+class HotelListModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { Id, Name, Price, Rating, Distance, City, ColumnCount };
+
+    explicit HotelListModel(QObject* parent = nullptr);
+
+    // Shows the snapshot's live hotels matching the filter, in the current sort order
+    void setSnapshot(HotelSnapshotPtr snapshot);
+    void setFilter(const HotelFilter& filter);
+    void setSkylineOnly(bool only);     // Keeps just the filtered hotels' Pareto front (see skyline.h)
+    size_t matchCount() const { return rows.size(); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    HotelSnapshotPtr snapshot;
+    HotelFilter filter;
+    bool skylineOnly = false;
+    int sortColumn = Id;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    vector<uint32_t> rows;      // Table rows in display order
+    int fetched = 0;            // Leading rows the view has been told about
+
+    void rebuild();
+};
+
+#endif // HOTELLISTMODEL_H
@@ -0,0 +1,396 @@
+#include "hotellog.h"
+#include "metrics.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'S', 'M', 'T', 'L', 'O', 'G', '0', '3'};
+
+const size_t RECORD_HEADER = 8;     // payload size + CRC
+const size_t FIXED_PAYLOAD = 32;    // type, id, price, rating, distance, latitude, longitude, name size
+const size_t FIXED_PAYLOAD_V2 = 20; // type, id, price, rating, distance
+
+uint32_t crc32(const char* data, size_t size)
+{
+    static const auto table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) c = table[(c ^ (uint8_t)data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+int openAppend(const string& path)
+{
+#ifdef _WIN32
+    int fd = -1;
+    _sopen_s(&fd, path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+    return fd;
+#else
+    return ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+}
+
+void closeFile(int fd)
+{
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+int64_t fileLength(int fd)
+{
+#ifdef _WIN32
+    return _lseeki64(fd, 0, SEEK_END);
+#else
+    return lseek(fd, 0, SEEK_END);
+#endif
+}
+
+bool writeAll(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, (unsigned)min<size_t>(size, 1u << 30));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        METRIC_ADD(BytesWritten, written);
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Reads from the start of the file until limit bytes or the end
+bool readFromStart(int fd, string& out, size_t limit = SIZE_MAX)
+{
+    out.clear();
+#ifdef _WIN32
+    if (_lseeki64(fd, 0, SEEK_SET) < 0) return false;
+#else
+    if (lseek(fd, 0, SEEK_SET) < 0) return false;
+#endif
+    char chunk[1 << 16];
+    while (out.size() < limit) {
+#ifdef _WIN32
+        int got = _read(fd, chunk, (unsigned)min(sizeof(chunk), limit - out.size()));
+#else
+        ssize_t got = ::read(fd, chunk, min(sizeof(chunk), limit - out.size()));
+#endif
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return false;
+        if (got == 0) return true;
+        METRIC_ADD(BytesRead, got);
+        out.append(chunk, got);
+    }
+    return true;
+}
+
+bool syncFile(int fd)
+{
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+}
+
+bool truncateFile(int fd, uint64_t size)
+{
+#ifdef _WIN32
+    return _chsize_s(fd, (__int64)size) == 0;
+#else
+    return ftruncate(fd, (off_t)size) == 0;
+#endif
+}
+
+// Header: magic, next ID, reserved
+string logHeader(int nextId)
+{
+    string header(16, '\0');
+    memcpy(&header[0], MAGIC, sizeof(MAGIC));
+    memcpy(&header[8], &nextId, 4);
+    return header;
+}
+
+} // namespace
+
+bool HotelLog::open(const string& logPath, const HotelLogOptions& logOptions)
+{
+    close();
+    int handle = openAppend(logPath);
+    if (handle < 0) return false;
+
+    int64_t length = fileLength(handle);
+    string head;
+    if (length < 0) {
+        closeFile(handle);
+        return false;
+    }
+    savedNextId = 0;
+    format = FORMAT;
+    if (length < (int64_t)HEADER_SIZE) {
+        // New file, or a crash while it was being created or reset
+        head = logHeader(0);
+        if (!truncateFile(handle, 0) || !writeAll(handle, head.data(), head.size()) || !syncFile(handle)) {
+            closeFile(handle);
+            return false;
+        }
+        length = HEADER_SIZE;
+    } else if (!readFromStart(handle, head, HEADER_SIZE) || memcmp(head.data(), MAGIC, sizeof(MAGIC) - 1) != 0
+               || head[7] < '2' || head[7] > MAGIC[7]) {
+        closeFile(handle);     // Not a hotel log (or one too old to replay); leave it alone
+        return false;
+    } else {
+        memcpy(&savedNextId, head.data() + 8, 4);
+        format = head[7] - '0';
+    }
+
+    fd = handle;
+    path = logPath;
+    options = logOptions;
+    fileSize = length;
+    buffer.clear();
+    unsynced = false;
+    syncFailed = false;
+    if (options.sync == HotelLogOptions::Interval) startFlusher();
+    return true;
+}
+
+void HotelLog::close()
+{
+    if (fd < 0) return;
+    stopFlusher();
+    sync();
+    closeFile(fd);
+    fd = -1;
+}
+
+void HotelLog::startFlusher()
+{
+    flusherStopping = false;
+    flusher = thread([this] {
+        unique_lock<mutex> lock(syncLock);
+        while (true) {
+            syncWake.wait(lock, [this] { return unsynced || flusherStopping; });
+            if (flusherStopping) return;     // close() syncs what is left
+            syncWake.wait_until(lock, dirtySince + chrono::milliseconds(options.intervalMs),
+                                [this] { return flusherStopping; });
+            if (flusherStopping) return;
+            if (!unsynced) continue;        // Synced by the owner in the meantime
+
+            // Writes that land while the file syncs mark it unsynced again
+            unsynced = false;
+            lock.unlock();
+            bool ok = syncFile(fd);
+            lock.lock();
+            if (!ok) {
+                syncFailed = true;
+                if (!unsynced) dirtySince = chrono::steady_clock::now();
+                unsynced = true;
+            }
+        }
+    });
+}
+
+void HotelLog::stopFlusher()
+{
+    if (!flusher.joinable()) return;
+    {
+        lock_guard<mutex> lock(syncLock);
+        flusherStopping = true;
+    }
+    syncWake.notify_all();
+    flusher.join();
+}
+
+size_t HotelLog::replay(const function<void(const HotelLogRecord&)>& visit)
+{
+    if (fd < 0 || !writeBuffer()) return 0;
+
+    string data;
+    if (!readFromStart(fd, data) || data.size() < HEADER_SIZE) return 0;
+
+    size_t at = HEADER_SIZE, count = 0;
+    while (data.size() - at >= RECORD_HEADER) {
+        uint32_t payloadSize, checksum;
+        memcpy(&payloadSize, data.data() + at, 4);
+        memcpy(&checksum, data.data() + at + 4, 4);
+        size_t fixed = format == FORMAT ? FIXED_PAYLOAD : FIXED_PAYLOAD_V2;
+        if (payloadSize < fixed || payloadSize > data.size() - at - RECORD_HEADER) break;
+
+        const char* payload = data.data() + at + RECORD_HEADER;
+        if (crc32(payload, payloadSize) != checksum) break;
+
+        int32_t type;
+        memcpy(&type, payload, 4);
+        if (type < HotelLogRecord::Add || type > HotelLogRecord::Remove) break;
+
+        HotelLogRecord record;
+        record.type = (HotelLogRecord::Type)type;
+        memcpy(&record.id, payload + 4, 4);
+        memcpy(&record.price, payload + 8, 4);
+        memcpy(&record.rating, payload + 12, 4);
+        memcpy(&record.distance, payload + 16, 4);
+        if (format == FORMAT) {
+            uint32_t nameSize;
+            memcpy(&record.latitude, payload + 20, 4);
+            memcpy(&record.longitude, payload + 24, 4);
+            memcpy(&nameSize, payload + 28, 4);
+            if (nameSize > payloadSize - FIXED_PAYLOAD) break;
+            record.name = string_view(payload + FIXED_PAYLOAD, nameSize);
+            record.city = string_view(payload + FIXED_PAYLOAD + nameSize, payloadSize - FIXED_PAYLOAD - nameSize);
+        } else {
+            record.name = string_view(payload + FIXED_PAYLOAD_V2, payloadSize - FIXED_PAYLOAD_V2);
+        }
+        visit(record);
+
+        at += RECORD_HEADER + payloadSize;
+        ++count;
+    }
+
+    if (at < data.size()) {
+        truncateFile(fd, at);
+        syncFile(fd);
+    }
+    fileSize = at;
+    return count;
+}
+
+void HotelLog::append(const HotelLogRecord& record)
+{
+    uint32_t payloadSize = FIXED_PAYLOAD + record.name.size() + record.city.size();
+    uint32_t nameSize = record.name.size();
+    size_t start = buffer.size();
+    buffer.resize(start + RECORD_HEADER + payloadSize);
+
+    int32_t type = record.type;
+    char* payload = &buffer[start + RECORD_HEADER];
+    memcpy(payload, &type, 4);
+    memcpy(payload + 4, &record.id, 4);
+    memcpy(payload + 8, &record.price, 4);
+    memcpy(payload + 12, &record.rating, 4);
+    memcpy(payload + 16, &record.distance, 4);
+    memcpy(payload + 20, &record.latitude, 4);
+    memcpy(payload + 24, &record.longitude, 4);
+    memcpy(payload + 28, &nameSize, 4);
+    memcpy(payload + FIXED_PAYLOAD, record.name.data(), nameSize);
+    memcpy(payload + FIXED_PAYLOAD + nameSize, record.city.data(), record.city.size());
+
+    uint32_t checksum = crc32(payload, payloadSize);
+    memcpy(&buffer[start], &payloadSize, 4);
+    memcpy(&buffer[start + 4], &checksum, 4);
+
+    if (buffer.size() >= options.bufferBytes) writeBuffer();
+}
+
+bool HotelLog::writeBuffer()
+{
+    if (buffer.empty()) return true;
+    if (fd < 0 || !writeAll(fd, buffer.data(), buffer.size())) return false;
+    fileSize += buffer.size();
+    buffer.clear();
+
+    lock_guard<mutex> lock(syncLock);
+    if (!unsynced) {
+        unsynced = true;
+        dirtySince = chrono::steady_clock::now();
+        syncWake.notify_all();
+    }
+    return true;
+}
+
+bool HotelLog::commit()
+{
+    METRIC_TIMER(LogAppend);
+    if (!writeBuffer()) return false;
+    switch (options.sync) {
+    case HotelLogOptions::EveryWrite:
+        return sync();
+    case HotelLogOptions::Interval: {
+        // The flusher syncs within intervalMs of the write
+        lock_guard<mutex> lock(syncLock);
+        bool ok = !syncFailed;
+        syncFailed = false;
+        return ok;
+    }
+    case HotelLogOptions::OnClose:
+        return true;
+    }
+    return true;
+}
+
+bool HotelLog::sync()
+{
+    if (!writeBuffer()) return false;
+    {
+        lock_guard<mutex> lock(syncLock);
+        if (!unsynced) return true;
+        unsynced = false;
+    }
+    if (syncFile(fd)) return true;
+    lock_guard<mutex> lock(syncLock);
+    if (!unsynced) dirtySince = chrono::steady_clock::now();
+    unsynced = true;
+    return false;
+}
+
+bool HotelLog::reset(int nextId)
+{
+    if (fd < 0) return false;
+    buffer.clear();
+
+    // The file is opened for appending, so the new header goes in after truncating to nothing
+    string head = logHeader(nextId);
+    if (!truncateFile(fd, 0) || !writeAll(fd, head.data(), head.size()) || !syncFile(fd)) return false;
+    fileSize = HEADER_SIZE;
+    savedNextId = nextId;
+    format = FORMAT;
+    lock_guard<mutex> lock(syncLock);
+    unsynced = false;
+    return true;
+}
+
+bool appendFileSynced(const string& path, string_view data)
+{
+    int fd = openAppend(path);
+    if (fd < 0) return false;
+    bool ok = writeAll(fd, data.data(), data.size()) && syncFile(fd);
+    closeFile(fd);
+    return ok;
+}
+
+bool replaceFileSynced(const string& path, string_view data)
+{
+    string tempPath = path + ".tmp";
+    error_code error;
+    filesystem::remove(tempPath, error);
+    if (!appendFileSynced(tempPath, data)) return false;
+    filesystem::rename(tempPath, path, error);
+    return !error;
+}
@@ -0,0 +1,103 @@
+#ifndef HOTELLOG_H
+#define HOTELLOG_H
+
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+using namespace std;
+
+struct HotelLogOptions {
+    enum Sync { EveryWrite, Interval, OnClose };
+
+    Sync sync = Interval;
+    int intervalMs = 100;                       // Interval: committed records are synced at most this long after they are written
+    size_t bufferBytes = 64 * 1024;             // Appends are written out once this much is buffered
+    size_t checkpointBytes = 4 * 1024 * 1024;   // HotelManager folds the log into information.bin past this size
+};
+
+struct HotelLogRecord {
+    enum Type { Add, Update, Remove };
+
+    Type type = Add;
+    int id;
+    int price;
+    float rating;
+    float distance;
+    string_view name;           // Empty for Remove
+    float latitude = NAN;
+    float longitude = NAN;
+    string_view city;
+};
+
+// Append-only log of hotel changes.
+// After a 16-byte header ("SMTLOG03", int32 next hotel ID, uint32 reserved) each record is
+//   uint32 payload size | uint32 CRC-32 of payload
+//   | int32 type, id, price, float rating, distance, latitude, longitude, uint32 name size | name | city
+// in native byte order, like information.bin. Appends are buffered and reach the file on commit(),
+// which then syncs according to the policy; a batch of appends followed by one commit is one group commit.
+// Under the Interval policy a background thread does the syncing, so an idle log is not left unsynced.
+// "SMTLOG02" logs, whose records stop after distance and the name, can still be replayed.
+class HotelLog {
+public:
+    HotelLog() = default;
+    ~HotelLog() { close(); }
+    HotelLog(const HotelLog&) = delete;
+    HotelLog& operator=(const HotelLog&) = delete;
+
+    bool open(const string& path, const HotelLogOptions& options = HotelLogOptions());  // Creates the file if needed
+    void close();                               // Commits and syncs whatever is pending
+    bool isOpen() const { return fd >= 0; }
+    bool isCurrentFormat() const { return format == FORMAT; }     // Older logs need a reset before appending
+
+    // Calls visit for every intact record in file order. A torn or corrupt tail, left by a crash
+    // mid-write, is cut off so later appends follow the last good record. Returns the record count.
+    size_t replay(const function<void(const HotelLogRecord&)>& visit);
+
+    void append(const HotelLogRecord& record);
+    bool commit();                              // Writes out buffered records, then syncs per policy; false if that or a background sync failed
+    bool sync();                                // Writes out buffered records and syncs now
+
+    // Empties the log once its records are saved elsewhere, remembering the next ID to hand out
+    bool reset(int nextId);
+    int nextId() const { return savedNextId; }  // As of the last reset, 0 for a new log
+
+    uint64_t size() const { return fileSize + buffer.size(); }     // Bytes, including buffered records
+    bool empty() const { return size() <= HEADER_SIZE; }
+
+private:
+    static const uint64_t HEADER_SIZE = 16;
+    static const int FORMAT = 3;
+
+    string path;
+    HotelLogOptions options;
+    int fd = -1;
+    string buffer;                              // Appended records not yet written
+    uint64_t fileSize = 0;
+    int savedNextId = 0;
+    int format = FORMAT;
+    thread flusher;                             // Interval policy only
+    mutex syncLock;                             // Guards the members below, shared with the flusher
+    condition_variable syncWake;
+    bool unsynced = false;                      // Written but not yet synced
+    bool syncFailed = false;                    // A background sync failed since the last commit
+    bool flusherStopping = false;
+    chrono::steady_clock::time_point dirtySince;    // When the oldest unsynced write happened
+
+    bool writeBuffer();
+    void startFlusher();
+    void stopFlusher();
+};
+
+// Appends data to the file at path and syncs it before returning
+bool appendFileSynced(const string& path, string_view data);
+
+// Replaces the file at path with data through a synced temporary file and a rename
+bool replaceFileSynced(const string& path, string_view data);
+
+#endif // HOTELLOG_H
@@ -0,0 +1,387 @@
+#include "hotelmanager.h"
+#include "metrics.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// Batches at least this large rebuild the sorted indexes rather than inserting row by row
+static const size_t BULK_REBUILD = 256;
+
+// City names are matched against Graph's, which are lowercase
+static string cityKey(string city)
+{
+    transform(city.begin(), city.end(), city.begin(), ::tolower);
+    return city;
+}
+
+HotelManager::HotelManager(const string& dataDir, const HotelLogOptions& logOptions)
+    : dataDir(dataDir), logOptions(logOptions)
+{
+    if (!log.open(dataDir + "/information.log", logOptions)) {
+        clog << "Unable to open " << dataDir << "/information.log, hotels will be written straight to information.bin" << endl;
+    }
+    readFromFile();
+}
+
+HotelManager::~HotelManager()
+{
+    checkpoint();
+}
+
+void HotelManager::readFromFile()
+{
+    METRIC_TIMER(HotelLoad);
+    string textPath = dataDir + "/information.txt";
+    string binaryPath = dataDir + "/information.bin";
+
+    // information.bin is the store; legacy text is converted only while there is none
+    error_code error;
+    bool converted = !filesystem::exists(binaryPath, error) && filesystem::exists(textPath, error)
+                     && convertLegacyHotels(textPath, binaryPath);
+
+    auto stamp = filesystem::last_write_time(binaryPath, error);
+    if (!converted && !error && loaded && stamp == loadedStamp) return;     // Nothing changed on disk
+
+    hotels.clear();
+    HotelStore store;
+    bool opened = store.open(binaryPath);
+    if (!opened && !converted && filesystem::exists(textPath, error)) {
+        // Written by an older version, or damaged: fall back to the legacy text
+        opened = convertLegacyHotels(textPath, binaryPath) && store.open(binaryPath);
+        stamp = filesystem::last_write_time(binaryPath, error);
+    }
+    if (opened) {
+        hotels.loadFrom(store);
+        loaded = true;
+        loadedStamp = stamp;
+    } else {
+        // No usable binary file (e.g. a read-only directory): parse the legacy text directly
+        HotelColumns columns;
+        if (!readLegacyHotels(textPath, columns)) clog << "Unable to open file " << textPath << endl;
+        hotels.reserve(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            hotels.append(columns.ids[i], columns.name(i), columns.prices[i], columns.ratings[i], columns.distances[i],
+                          columns.location(i));
+        }
+        loaded = false;
+    }
+
+    // Records information.bin already reflects were checkpointed just before a crash: adds of IDs
+    // the table has are skipped, and updates and removals are idempotent
+    unsaved = log.replay([&](const HotelLogRecord& record) {
+        size_t row = hotels.findId(record.id);
+        HotelLocation location{record.latitude, record.longitude, record.city};
+        switch (record.type) {
+        case HotelLogRecord::Add:
+            if (row == HotelTable::NONE) hotels.append(record.id, record.name, record.price, record.rating, record.distance, location);
+            break;
+        case HotelLogRecord::Update:
+            if (row != HotelTable::NONE) hotels.update(row, record.name, record.price, record.rating, record.distance, location);
+            break;
+        case HotelLogRecord::Remove:
+            if (row != HotelTable::NONE) hotels.remove(row);
+            break;
+        }
+    }) > 0;
+    nextId = max(hotels.maxId() + 1, log.nextId());
+
+    indexes.rebuild(hotels);
+    nameIndex.rebuild(hotels);
+    geoIndex.rebuild(hotels);
+
+    // A log in an older format is folded into information.bin, then reset in the current one
+    if (log.isOpen() && !log.isCurrentFormat()) {
+        unsaved = true;
+        checkpoint();
+        if (!log.isCurrentFormat()) log.close();
+    }
+
+    stale = AllParts;
+    if (batchDepth == 0) publish();
+}
+
+bool HotelManager::checkpoint()
+{
+    if (!unsaved) return true;
+    METRIC_TIMER(HotelCheckpoint);
+
+    string path = dataDir + "/information.bin";
+    HotelColumns columns;
+    for (size_t row = 0; row < hotels.size(); ++row) {
+        if (hotels.isLive(row)) {
+            columns.append(hotels.id(row), hotels.name(row), hotels.price(row), hotels.rating(row), hotels.distance(row),
+                           hotels.location(row));
+        }
+    }
+    if (!HotelStore::write(path, columns)) {
+        clog << "Failed to write to file at: " << path << endl;
+        return false;
+    }
+
+    // The table matches the new file, so an unchanged reload keeps it. A crash before the log
+    // reset replays these records again, which the load tolerates.
+    error_code error;
+    loadedStamp = filesystem::last_write_time(path, error);
+    loaded = !error;
+    unsaved = false;
+    if (log.isOpen()) log.reset(nextId);
+    return true;
+}
+
+bool HotelManager::exportText(const string& path) const
+{
+    ostringstream text;
+    for (size_t row = 0; row < hotels.size(); ++row) {
+        if (!hotels.isLive(row)) continue;
+        text << hotels.id(row) << " " << hotels.name(row) << " "
+             << hotels.price(row) << " " << hotels.rating(row) << " "
+             << hotels.distance(row);
+        HotelLocation location = hotels.location(row);
+        if (!location.empty()) {
+            text << setprecision(9) << " " << location.latitude << " " << location.longitude;
+            if (!location.city.empty()) text << " " << location.city;
+            text << setprecision(6);
+        }
+        text << "\n";
+    }
+    return replaceFileSynced(path, text.str());
+}
+
+int HotelManager::addHotels(const vector<Hotel>& batch)
+{
+    int firstId = nextId;
+    nextId += batch.size();
+    bool bulk = batch.size() >= BULK_REBUILD;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const Hotel& h = batch[i];
+        int id = firstId + (int)i;
+        string city = cityKey(h.getCity());
+        size_t row = hotels.append(id, h.getName(), h.getPrice(), h.getRating(), h.getDistance(),
+                                   {h.getLatitude(), h.getLongitude(), city});
+        if (!bulk) {
+            indexes.insert(hotels, row);
+            nameIndex.insert(hotels, row);
+            geoIndex.insert(hotels, row);
+        }
+        if (log.isOpen()) {
+            log.append({HotelLogRecord::Add, id, h.getPrice(), h.getRating(), h.getDistance(), h.getName(),
+                        h.getLatitude(), h.getLongitude(), city});
+        }
+    }
+    unsaved = true;
+    if (bulk) {
+        indexes.rebuild(hotels);
+        nameIndex.rebuild(hotels);
+        geoIndex.rebuild(hotels);
+    }
+
+    changed(AllParts);
+    return firstId;
+}
+
+void HotelManager::changed(unsigned parts)
+{
+    stale |= parts;
+    if (batchDepth > 0) return;
+    commit();
+    publish();
+}
+
+void HotelManager::publish()
+{
+    if (!stale) return;
+
+    HotelSnapshotPtr current = atomic_load(&published);
+    auto next = current ? make_shared<HotelSnapshot>(*current) : make_shared<HotelSnapshot>();
+    next->version = current ? current->version + 1 : 1;
+    if (!current || stale & TablePart) next->table = make_shared<const HotelTable>(hotels);
+    if (!current || stale & PricePart) next->byPrice = make_shared<const SortedIndex>(indexes.byPrice);
+    if (!current || stale & RatingPart) next->byRating = make_shared<const SortedIndex>(indexes.byRating);
+    if (!current || stale & DistancePart) next->byDistance = make_shared<const SortedIndex>(indexes.byDistance);
+    if (!current || stale & NamePart) {
+        next->byName = make_shared<const SortedIndex>(indexes.byName);
+        next->nameIndex = make_shared<const NameIndex>(nameIndex);
+    }
+    if (!current || stale & GeoPart) next->geo = make_shared<const GeoIndex>(geoIndex);
+    stale = 0;
+    atomic_store(&published, HotelSnapshotPtr(move(next)));
+}
+
+void HotelManager::commit()
+{
+    // Without a working log changes go straight to information.bin
+    if (!log.isOpen() || !log.commit() || log.size() >= logOptions.checkpointBytes) checkpoint();
+}
+
+bool HotelManager::getById(int id, Hotel& hotel) const
+{
+    size_t row = hotels.findId(id);
+    if (row == HotelTable::NONE) return false;
+    hotel = getHotel(row);
+    return true;
+}
+
+bool HotelManager::updateById(int id, const Hotel& values)
+{
+    size_t row = hotels.findId(id);
+    if (row == HotelTable::NONE) return false;
+
+    // Only the indexes whose key changes move the row
+    bool priceChanged = values.getPrice() != hotels.price(row);
+    bool ratingChanged = values.getRating() != hotels.rating(row);
+    bool distanceChanged = values.getDistance() != hotels.distance(row);
+    bool nameChanged = values.getName() != hotels.name(row);
+    string city = cityKey(values.getCity());
+    HotelLocation location{values.getLatitude(), values.getLongitude(), city};
+    auto same = [](float a, float b) { return a == b || (isnan(a) && isnan(b)); };
+    bool locationChanged = !same(location.latitude, hotels.latitude(row))
+                           || !same(location.longitude, hotels.longitude(row)) || city != hotels.city(row);
+    if (locationChanged) geoIndex.remove(hotels, row);
+    if (priceChanged) indexes.byPrice.erase(hotels, row);
+    if (ratingChanged) indexes.byRating.erase(hotels, row);
+    if (distanceChanged) indexes.byDistance.erase(hotels, row);
+    if (nameChanged) indexes.byName.erase(hotels, row);
+
+    hotels.update(row, values.getName(), values.getPrice(), values.getRating(), values.getDistance(), location);
+
+    if (priceChanged) indexes.byPrice.insert(hotels, row);
+    if (ratingChanged) indexes.byRating.insert(hotels, row);
+    if (distanceChanged) indexes.byDistance.insert(hotels, row);
+    if (nameChanged) {
+        indexes.byName.insert(hotels, row);
+        nameIndex.update(hotels, row);
+    }
+    if (locationChanged) geoIndex.insert(hotels, row);
+
+    if (log.isOpen()) {
+        log.append({HotelLogRecord::Update, id, values.getPrice(), values.getRating(), values.getDistance(), values.getName(),
+                    location.latitude, location.longitude, city});
+    }
+    unsaved = true;
+    changed(TablePart | (priceChanged ? PricePart : 0) | (ratingChanged ? RatingPart : 0)
+            | (distanceChanged ? DistancePart : 0) | (nameChanged ? NamePart : 0) | (locationChanged ? GeoPart : 0));
+    return true;
+}
+
+bool HotelManager::removeById(int id)
+{
+    size_t row = hotels.findId(id);
+    if (row == HotelTable::NONE) return false;
+
+    indexes.erase(hotels, row);
+    nameIndex.remove(hotels, row);
+    geoIndex.remove(hotels, row);
+    hotels.remove(row);
+
+    if (log.isOpen()) log.append({HotelLogRecord::Remove, id, 0, 0, 0, {}, NAN, NAN, {}});
+    unsaved = true;
+    changed(AllParts);
+    return true;
+}
+
+string HotelManager::addHotel(const string& name, int price, float rating, float distance,
+                              const HotelLocation& location)
+{
+    Hotel hotel(0, name, price, rating, distance);
+    hotel.setCoordinates(location.latitude, location.longitude);
+    hotel.setCity(string(location.city));
+    int id = addHotels({hotel});
+    return "Hotel added successfully with ID: H" + to_string(id);
+}
+
+void HotelManager::addHotel()
+{
+    Hotel newHotel;
+
+    string name;
+    int price;
+    float rating, distance;
+
+    cout << "Enter hotel name: ";
+    cin.ignore();
+    getline(cin, name);
+    newHotel.setName(name);
+
+    cout << "Enter price: $";
+    cin >> price;
+    newHotel.setPrice(price);
+
+    cout << "Enter rating (0.0-5.0): ";
+    cin >> rating;
+    newHotel.setRating(rating);
+
+    cout << "Enter distance from city center (km): ";
+    cin >> distance;
+    newHotel.setDistance(distance);
+
+    int id = addHotels({newHotel});
+    cout << "Hotel added successfully with ID: H" << id << endl;
+}
+
+void HotelManager::viewAllHotels()
+{
+    // Force refresh to read the latest data from the file (to prevent the file from being modified while the program is running and cannot be seen)
+    readFromFile();
+
+    if (hotels.empty()) {
+        cout << "No hotels available." << endl;
+        return;
+    }
+
+    cout << "\n=== All Hotels (2 rows × 5 columns) ===\n" << endl;
+
+    const int columns = 5;
+    size_t shown = 0;
+    for (size_t i = 0; i < hotels.size(); ++i) {
+        if (!hotels.isLive(i)) continue;
+        Hotel h = getHotel(i);
+
+        cout << "H" << h.getId()
+             << " | " << h.getName()
+             << " | $" << h.getPrice()
+             << " | ⭐" << h.getRating()
+             << " | " << h.getDistance() << "km\t";
+
+        if (++shown % columns == 0)
+            cout << endl;
+    }
+
+    if (shown % columns != 0)
+        cout << endl;
+}
+
+vector<uint32_t> HotelManager::topK(const vector<SortKey>& keys, size_t k, const HotelFilter& filter) const
+{
+    vector<uint32_t> rows;
+    indexedTopK(hotels, indexes.byPrice, indexes.byRating, indexes.byDistance, keys, k, filter, rows);
+    return rows;
+}
+
+vector<uint32_t> HotelManager::skyline(const HotelFilter& filter) const
+{
+    vector<uint32_t> rows;
+    ::skyline(hotels, indexes.byPrice.all(), filter, rows);
+    return rows;
+}
+
+vector<GeoHit> HotelManager::nearest(float latitude, float longitude, size_t k, const HotelFilter& filter) const
+{
+    vector<GeoHit> hits;
+    geoIndex.nearest(hotels, latitude, longitude, k, filter, hits);
+    return hits;
+}
+
+vector<GeoHit> HotelManager::within(float latitude, float longitude, float km, const HotelFilter& filter) const
+{
+    vector<GeoHit> hits;
+    geoIndex.within(hotels, latitude, longitude, km, filter, hits);
+    return hits;
+}
+
+vector<GeoHit> HotelManager::withinByRoad(const Graph& graph, const string& city, float km,
+                                          const HotelFilter& filter) const
+{
+    vector<GeoHit> hits;
+    ::withinByRoad(graph.core, hotels, geoIndex, graph.findCity(city), km, filter, hits);
+    return hits;
+}
@@ -0,0 +1,136 @@
+#ifndef HOTELMANAGER_H
+#define HOTELMANAGER_H
+
+#include <vector>
+#include <string>
+#include <filesystem>
+#include "hotel.h"
+#include "hotellog.h"
+#include "hotelstore.h"
+#include "hoteltable.h"
+#include "hotelindex.h"
+#include "nameindex.h"
+#include "geoindex.h"
+#include "graph.h"
+#include "topk.h"
+#include "hotelsnapshot.h"
+using namespace std;
+
+// Owns the hotels of one data directory. information.bin holds them; changes are logged to
+// information.log and folded into information.bin at checkpoints, so only one HotelManager may use
+// a directory at a time. A legacy information.txt is converted once, when there is no information.bin.
+//
+// HotelManager has a single writer: its methods are called from one thread at a time, and the
+// query methods below read that thread's working copy. Other threads query through snapshot(),
+// an immutable version the writer publishes after every change (or once per UpdateBatch).
+class HotelManager {
+private:
+    string dataDir;                             // Holds information.bin, information.log and any legacy information.txt
+    HotelTable hotels;
+    HotelIndexes indexes;                       // Sorted views of hotels, kept in step on every change
+    NameIndex nameIndex;
+    GeoIndex geoIndex;
+    bool loaded = false;                        // hotels mirrors information.bin as of loadedStamp
+    filesystem::file_time_type loadedStamp;
+    HotelLogOptions logOptions;
+    HotelLog log;                               // information.log: changes since the last checkpoint
+    bool unsaved = false;                       // Changes in the log but not yet in information.bin
+    int nextId = 1;                             // Never reused, even after removals
+
+    // Parts of the working copy changed since the last publish
+    enum Part { TablePart = 1, PricePart = 2, RatingPart = 4, DistancePart = 8, NamePart = 16, GeoPart = 32, AllParts = 63 };
+    unsigned stale = AllParts;
+    HotelSnapshotPtr published;                 // Only accessed through atomic_load / atomic_store
+    int batchDepth = 0;
+
+    void changed(unsigned parts);               // Commits and publishes unless a batch is open
+    void commit();                              // Commits the logged change, checkpointing when due
+
+public:
+    explicit HotelManager(const string& dataDir = ".", const HotelLogOptions& logOptions = HotelLogOptions());
+    ~HotelManager();
+    HotelManager(const HotelManager&) = delete;
+    HotelManager& operator=(const HotelManager&) = delete;
+
+    const string& getDataDir() const { return dataDir; }
+
+    // Loads information.bin (converting information.txt if there is none), then replays information.log on top
+    void readFromFile();
+
+    // Rewrites information.bin with the live hotels and empties the log. Runs on destruction and
+    // whenever the log outgrows logOptions.checkpointBytes.
+    bool checkpoint();
+
+    // Writes the live hotels to path in the legacy information.txt format, e.g. for hand editing.
+    // The manager never reads the file back unless it is converted into a fresh data directory.
+    bool exportText(const string& path) const;
+
+    string addHotel(const string& name, int price, float rating, float distance,
+                    const HotelLocation& location = HotelLocation());
+    void addHotel();                            // Interactive, reads the fields from cin
+
+    // Adds the hotels with consecutive new IDs (their own IDs are ignored) and returns the first one.
+    // The whole batch is one log commit; large batches rebuild the indexes instead of inserting.
+    int addHotels(const vector<Hotel>& batch);
+    void viewAllHotels();
+
+    // Columnar storage; rows are stable until the next readFromFile
+    const HotelTable& getHotels() const { return hotels; }
+
+    // Rows in sorted order: price ascending, rating descending, distance ascending
+    IndexSpan sortedByPrice() const { return indexes.byPrice.all(); }
+    IndexSpan sortedByRating() const { return indexes.byRating.all(); }
+    IndexSpan sortedByDistance() const { return indexes.byDistance.all(); }
+
+    // Rows named exactly name, empty if there are none
+    RowSpan findByName(const string& name) const { return nameIndex.exact(hotels, name); }
+
+    // Prefix, substring and fuzzy name search (results are NamePool ids, see NameIndex::rowsOf)
+    const NameIndex& getNameIndex() const { return nameIndex; }
+
+    // The k best rows matching filter under a compound ordering, e.g. {{SortKey::Rating, true}, {SortKey::Price}}
+    vector<uint32_t> topK(const vector<SortKey>& keys, size_t k, const HotelFilter& filter = HotelFilter()) const;
+    vector<uint32_t> topK(SortKey key, size_t k, const HotelFilter& filter = HotelFilter()) const {
+        return topK(vector<SortKey>{key}, k, filter);
+    }
+
+    // Rows matching filter that no other matching hotel beats on price, rating and distance at once,
+    // cheapest first (see skyline.h; rankSkyline orders them by weighted score)
+    vector<uint32_t> skyline(const HotelFilter& filter = HotelFilter()) const;
+
+    // Constant-time access by hotel ID (the number after "H"); false if there is no such hotel
+    bool getById(int id, Hotel& hotel) const;
+    bool updateById(int id, const Hotel& values);      // Takes every field but the ID from values
+    bool removeById(int id);
+
+    Hotel getHotel(size_t row) const { return hotelAt(hotels, row); }
+
+    // Live rows matching filter by straight-line distance from a point (degrees), nearest first
+    vector<GeoHit> nearest(float latitude, float longitude, size_t k, const HotelFilter& filter = HotelFilter()) const;
+    vector<GeoHit> within(float latitude, float longitude, float km, const HotelFilter& filter = HotelFilter()) const;
+
+    // Hotels at most km by road from city, counting each hotel's distance from its own city's centre
+    vector<GeoHit> withinByRoad(const Graph& graph, const string& city, float km,
+                                const HotelFilter& filter = HotelFilter()) const;
+
+    // Latest published version; safe from any thread, and the handle never blocks the writer
+    HotelSnapshotPtr snapshot() const { return atomic_load(&published); }
+
+    // Publishes the working copy if it changed. Writes publish on their own outside a batch.
+    void publish();
+
+    // Defers log commits and publication until the outermost batch ends, so a feed of
+    // updates costs one commit and one new snapshot
+    class UpdateBatch {
+    public:
+        explicit UpdateBatch(HotelManager& manager) : manager(manager) { manager.batchDepth++; }
+        ~UpdateBatch() { if (--manager.batchDepth == 0) manager.changed(0); }
+        UpdateBatch(const UpdateBatch&) = delete;
+        UpdateBatch& operator=(const UpdateBatch&) = delete;
+
+    private:
+        HotelManager& manager;
+    };
+};
+
+#endif // HOTELMANAGER_H
@@ -0,0 +1,78 @@
+#include "hotelsnapshot.h"
+#include "metrics.h"
+
+vector<uint32_t> HotelSnapshot::topK(const vector<SortKey>& keys, size_t k, const HotelFilter& filter) const
+{
+    vector<uint32_t> rows;
+    indexedTopK(*table, *byPrice, *byRating, *byDistance, keys, k, filter, rows);
+    return rows;
+}
+
+vector<uint32_t> HotelSnapshot::skyline(const HotelFilter& filter) const
+{
+    vector<uint32_t> rows;
+    ::skyline(*table, byPrice->all(), filter, rows);
+    return rows;
+}
+
+vector<GeoHit> HotelSnapshot::nearest(float latitude, float longitude, size_t k, const HotelFilter& filter) const
+{
+    vector<GeoHit> hits;
+    geo->nearest(*table, latitude, longitude, k, filter, hits);
+    return hits;
+}
+
+vector<GeoHit> HotelSnapshot::within(float latitude, float longitude, float km, const HotelFilter& filter) const
+{
+    vector<GeoHit> hits;
+    geo->within(*table, latitude, longitude, km, filter, hits);
+    return hits;
+}
+
+vector<GeoHit> HotelSnapshot::withinByRoad(const Graph& graph, const string& city, float km,
+                                           const HotelFilter& filter) const
+{
+    vector<GeoHit> hits;
+    ::withinByRoad(graph.core, *table, *geo, graph.findCity(city), km, filter, hits);
+    return hits;
+}
+
+bool HotelSnapshot::getById(int id, Hotel& hotel) const
+{
+    size_t row = table->findId(id);
+    if (row == HotelTable::NONE) return false;
+    hotel = getHotel(row);
+    return true;
+}
+
+Hotel hotelAt(const HotelTable& table, size_t row)
+{
+    Hotel hotel(table.id(row), string(table.name(row)), table.price(row), table.rating(row), table.distance(row));
+    hotel.setCoordinates(table.latitude(row), table.longitude(row));
+    hotel.setCity(string(table.city(row)));
+    return hotel;
+}
+
+void indexedTopK(const HotelTable& table, const SortedIndex& byPrice, const SortedIndex& byRating,
+                 const SortedIndex& byDistance, const vector<SortKey>& keys, size_t k, const HotelFilter& filter,
+                 vector<uint32_t>& rows)
+{
+    METRIC_TIMER(TopK);
+    rows.clear();
+
+    const SortedIndex* index = nullptr;
+    if (keys.size() == 1) {
+        if (keys[0].attribute == SortKey::Price && !keys[0].descending) index = &byPrice;
+        if (keys[0].attribute == SortKey::Rating && keys[0].descending) index = &byRating;
+        if (keys[0].attribute == SortKey::Distance && !keys[0].descending) index = &byDistance;
+    }
+    if (index) {
+        for (uint32_t row : index->all()) {
+            if (rows.size() == k) break;
+            if (filter.matches(table.price(row), table.rating(row), table.distance(row))) rows.push_back(row);
+        }
+        return;
+    }
+
+    topK(table, keys, k, filter, rows);
+}
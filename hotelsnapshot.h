@@ -0,0 +1,64 @@
+#ifndef HOTELSNAPSHOT_H
+#define HOTELSNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "hotel.h"
+#include "hoteltable.h"
+#include "hotelindex.h"
+#include "nameindex.h"
+#include "geoindex.h"
+#include "graph.h"
+#include "topk.h"
+#include "skyline.h"
+using namespace std;
+
+// Every field of one row as a Hotel
+Hotel hotelAt(const HotelTable& table, size_t row);
+
+// One published version of the hotel data. Nothing it points to changes after publication, and
+// consecutive versions share whichever parts a change left alone. The table and the sorted indexes
+// are themselves shared chunk by chunk, so a price update copies one chunk of the price column and
+// one block of the price index, plus a pointer per chunk and block. Any number of threads may
+// query it at once.
+struct HotelSnapshot {
+    uint64_t version = 0;
+    shared_ptr<const HotelTable> table;
+    shared_ptr<const SortedIndex> byPrice;
+    shared_ptr<const SortedIndex> byRating;
+    shared_ptr<const SortedIndex> byDistance;
+    shared_ptr<const SortedIndex> byName;
+    shared_ptr<const NameIndex> nameIndex;
+    shared_ptr<const GeoIndex> geo;
+
+    const HotelTable& hotels() const { return *table; }
+
+    IndexSpan sortedByPrice() const { return byPrice->all(); }
+    IndexSpan sortedByRating() const { return byRating->all(); }
+    IndexSpan sortedByDistance() const { return byDistance->all(); }
+    RowSpan findByName(const string& name) const { return nameIndex->exact(*table, name); }
+    const NameIndex& names() const { return *nameIndex; }
+
+    vector<uint32_t> topK(const vector<SortKey>& keys, size_t k, const HotelFilter& filter = HotelFilter()) const;
+    vector<uint32_t> skyline(const HotelFilter& filter = HotelFilter()) const;
+
+    vector<GeoHit> nearest(float latitude, float longitude, size_t k, const HotelFilter& filter = HotelFilter()) const;
+    vector<GeoHit> within(float latitude, float longitude, float km, const HotelFilter& filter = HotelFilter()) const;
+    vector<GeoHit> withinByRoad(const Graph& graph, const string& city, float km,
+                                const HotelFilter& filter = HotelFilter()) const;
+
+    bool getById(int id, Hotel& hotel) const;
+    Hotel getHotel(size_t row) const { return hotelAt(*table, row); }
+};
+
+// Reference-counted handle; the version stays alive while any reader holds one
+typedef shared_ptr<const HotelSnapshot> HotelSnapshotPtr;
+
+// topK that walks a sorted index when the ordering is a single key in that index's direction
+void indexedTopK(const HotelTable& table, const SortedIndex& byPrice, const SortedIndex& byRating,
+                 const SortedIndex& byDistance, const vector<SortKey>& keys, size_t k, const HotelFilter& filter,
+                 vector<uint32_t>& rows);
+
+#endif // HOTELSNAPSHOT_H
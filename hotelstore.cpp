@@ -0,0 +1,273 @@
+#include "hotelstore.h"
+#include "hotellog.h"
+#include "metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'S', 'M', 'T', 'H', 'O', 'T', 'E', 'L'};
+
+uint64_t align8(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+
+// Returns the next whitespace-separated token, or an empty view at end of input
+string_view nextToken(const char*& at, const char* end)
+{
+    while (at < end && isSpace(*at)) ++at;
+    const char* start = at;
+    while (at < end && !isSpace(*at)) ++at;
+    return string_view(start, at - start);
+}
+
+template <typename T>
+bool parseNumber(string_view token, T& value)
+{
+    if (token.empty()) return false;
+    const char* first = token.data();
+    if (*first == '+') ++first;
+    return from_chars(first, token.data() + token.size(), value).ec == errc();
+}
+
+} // namespace
+
+bool MappedFile::open(const string& path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        return false;
+    }
+    fileHandle = handle;
+    length = (size_t)fileSize.QuadPart;
+    if (length > 0) {
+        mappingHandle = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle) base = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!base) {
+            close();
+            return false;
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = info.st_size;
+    if (length > 0) {
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(mapped, length, MADV_WILLNEED);
+        base = (const char*)mapped;
+    }
+    ::close(fd);    // The mapping keeps the file alive
+#endif
+    opened = true;
+    METRIC_ADD(BytesRead, length);
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    if (base) munmap((void*)base, length);
+#endif
+    base = nullptr;
+    length = 0;
+    opened = false;
+}
+
+void HotelColumns::clear()
+{
+    ids.clear();
+    prices.clear();
+    ratings.clear();
+    distances.clear();
+    latitudes.clear();
+    longitudes.clear();
+    nameOffsets.assign(1, 0);
+    names.clear();
+    cityOffsets.assign(1, 0);
+    cities.clear();
+}
+
+void HotelColumns::append(int id, string_view name, int price, float rating, float distance, const HotelLocation& location)
+{
+    ids.push_back(id);
+    prices.push_back(price);
+    ratings.push_back(rating);
+    distances.push_back(distance);
+    latitudes.push_back(location.latitude);
+    longitudes.push_back(location.longitude);
+    names.append(name);
+    nameOffsets.push_back(names.size());
+    cities.append(location.city);
+    cityOffsets.push_back(cities.size());
+}
+
+bool HotelStore::open(const string& path)
+{
+    close();
+    if (!file.open(path)) return false;
+
+    size_t fileSize = file.size();
+    const char* base = file.data();
+    const HotelFileHeader* h = (const HotelFileHeader*)base;
+    if (fileSize < sizeof(HotelFileHeader) || memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0
+        || h->version != VERSION) {
+        file.close();
+        return false;
+    }
+
+    uint64_t n = h->count;
+    auto fits = [&](uint64_t offset, uint64_t bytes) {
+        return offset % 8 == 0 && offset <= fileSize && bytes <= fileSize - offset;
+    };
+    if (n > fileSize || !fits(h->idsOffset, n * 4) || !fits(h->pricesOffset, n * 4)
+        || !fits(h->ratingsOffset, n * 4) || !fits(h->distancesOffset, n * 4)
+        || !fits(h->nameOffsetsOffset, (n + 1) * 4) || !fits(h->namesOffset, h->namesSize)
+        || !fits(h->latitudesOffset, n * 4) || !fits(h->longitudesOffset, n * 4)
+        || !fits(h->cityOffsetsOffset, (n + 1) * 4) || !fits(h->citiesOffset, h->citiesSize)) {
+        file.close();
+        return false;
+    }
+
+    ids = (const int32_t*)(base + h->idsOffset);
+    prices = (const int32_t*)(base + h->pricesOffset);
+    ratings = (const float*)(base + h->ratingsOffset);
+    distances = (const float*)(base + h->distancesOffset);
+    nameOffsets = (const uint32_t*)(base + h->nameOffsetsOffset);
+    names = base + h->namesOffset;
+    latitudes = (const float*)(base + h->latitudesOffset);
+    longitudes = (const float*)(base + h->longitudesOffset);
+    cityOffsets = (const uint32_t*)(base + h->cityOffsetsOffset);
+    cities = base + h->citiesOffset;
+    // Offsets that never decrease and end inside the heap keep every string within it
+    auto ordered = [&](const uint32_t* offsets, uint64_t heapSize) {
+        for (uint64_t i = 0; i < n; ++i) {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        return offsets[n] <= heapSize;
+    };
+    if (!ordered(nameOffsets, h->namesSize) || !ordered(cityOffsets, h->citiesSize)) {
+        file.close();
+        return false;
+    }
+    header = h;
+    return true;
+}
+
+bool HotelStore::write(const string& path, const HotelColumns& columns)
+{
+    if (columns.names.size() > UINT32_MAX || columns.cities.size() > UINT32_MAX) return false;
+
+    uint64_t n = columns.size();
+    HotelFileHeader h = {};
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.count = n;
+    h.idsOffset = align8(sizeof(HotelFileHeader));
+    h.pricesOffset = align8(h.idsOffset + n * 4);
+    h.ratingsOffset = align8(h.pricesOffset + n * 4);
+    h.distancesOffset = align8(h.ratingsOffset + n * 4);
+    h.nameOffsetsOffset = align8(h.distancesOffset + n * 4);
+    h.namesOffset = align8(h.nameOffsetsOffset + (n + 1) * 4);
+    h.namesSize = columns.names.size();
+    h.latitudesOffset = align8(h.namesOffset + h.namesSize);
+    h.longitudesOffset = align8(h.latitudesOffset + n * 4);
+    h.cityOffsetsOffset = align8(h.longitudesOffset + n * 4);
+    h.citiesOffset = align8(h.cityOffsetsOffset + (n + 1) * 4);
+    h.citiesSize = columns.cities.size();
+
+    string image;
+    image.reserve(h.citiesOffset + h.citiesSize);
+    auto put = [&](uint64_t offset, const void* bytes, uint64_t count) {
+        image.resize(offset, '\0');
+        image.append((const char*)bytes, count);
+    };
+    put(0, &h, sizeof(h));
+    put(h.idsOffset, columns.ids.data(), n * 4);
+    put(h.pricesOffset, columns.prices.data(), n * 4);
+    put(h.ratingsOffset, columns.ratings.data(), n * 4);
+    put(h.distancesOffset, columns.distances.data(), n * 4);
+    put(h.nameOffsetsOffset, columns.nameOffsets.data(), (n + 1) * 4);
+    put(h.namesOffset, columns.names.data(), h.namesSize);
+    put(h.latitudesOffset, columns.latitudes.data(), n * 4);
+    put(h.longitudesOffset, columns.longitudes.data(), n * 4);
+    put(h.cityOffsetsOffset, columns.cityOffsets.data(), (n + 1) * 4);
+    put(h.citiesOffset, columns.cities.data(), h.citiesSize);
+    return replaceFileSynced(path, image);
+}
+
+bool readLegacyHotels(const string& path, HotelColumns& out)
+{
+    MappedFile text;
+    if (!text.open(path)) return false;
+
+    out.clear();
+    const char* at = text.data();
+    const char* end = at + text.size();
+    string city;
+    while (at < end) {
+        const char* line = at;
+        const char* lineEnd = static_cast<const char*>(memchr(at, '\n', end - at));
+        if (!lineEnd) lineEnd = end;
+        at = lineEnd == end ? end : lineEnd + 1;
+
+        int id, price;
+        float rating, distance;
+        if (!parseNumber(nextToken(line, lineEnd), id)) continue;
+        string_view name = nextToken(line, lineEnd);
+        if (name.empty()) continue;
+        if (!parseNumber(nextToken(line, lineEnd), price)) continue;
+        if (!parseNumber(nextToken(line, lineEnd), rating)) continue;
+        if (!parseNumber(nextToken(line, lineEnd), distance)) continue;
+
+        // Optional location on the rest of the line
+        HotelLocation location;
+        string_view latitude = nextToken(line, lineEnd);
+        if (!latitude.empty()) {
+            if (!parseNumber(latitude, location.latitude)) continue;
+            if (!parseNumber(nextToken(line, lineEnd), location.longitude)) continue;
+            // Lowercased like the cities HotelManager adds, to match Graph's names
+            city = nextToken(line, lineEnd);
+            transform(city.begin(), city.end(), city.begin(), ::tolower);
+            location.city = city;
+        }
+        out.append(id, name, price, rating, distance, location);
+    }
+    return true;
+}
+
+bool convertLegacyHotels(const string& textPath, const string& binaryPath)
+{
+    HotelColumns columns;
+    return readLegacyHotels(textPath, columns) && HotelStore::write(binaryPath, columns);
+}
@@ -0,0 +1,145 @@
+#ifndef HOTELSTORE_H
+#define HOTELSTORE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& path);
+    void close();
+    bool isOpen() const { return opened; }
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    bool opened = false;
+    const char* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// Where a hotel is: coordinates in degrees, NaN when unknown, and the graph city it belongs to
+struct HotelLocation {
+    float latitude = NAN;
+    float longitude = NAN;
+    string_view city;           // Lowercase like Graph's city names; empty when not attached
+
+    bool hasCoordinates() const { return !isnan(latitude) && !isnan(longitude); }
+    bool empty() const { return !hasCoordinates() && city.empty(); }
+};
+
+// Column buffers used to build and convert hotel files
+struct HotelColumns {
+    vector<int32_t> ids;
+    vector<int32_t> prices;
+    vector<float> ratings;
+    vector<float> distances;
+    vector<float> latitudes;
+    vector<float> longitudes;
+    vector<uint32_t> nameOffsets{0};    // Name i is names[nameOffsets[i], nameOffsets[i + 1])
+    string names;
+    vector<uint32_t> cityOffsets{0};    // Same layout for city names
+    string cities;
+
+    size_t size() const { return ids.size(); }
+    string_view name(size_t i) const { return string_view(names).substr(nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]); }
+    HotelLocation location(size_t i) const {
+        return {latitudes[i], longitudes[i], string_view(cities).substr(cityOffsets[i], cityOffsets[i + 1] - cityOffsets[i])};
+    }
+    void clear();
+    void append(int id, string_view name, int price, float rating, float distance,
+                const HotelLocation& location = HotelLocation());
+};
+
+// On-disk layout (little-endian), every section 8-byte aligned:
+//   header | ids int32[n] | prices int32[n] | ratings float[n] | distances float[n]
+//   | nameOffsets uint32[n + 1] | name heap
+//   | latitudes float[n] | longitudes float[n] | cityOffsets uint32[n + 1] | city heap    (version 2)
+struct HotelFileHeader {
+    char magic[8];              // "SMTHOTEL"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t idsOffset;
+    uint64_t pricesOffset;
+    uint64_t ratingsOffset;
+    uint64_t distancesOffset;
+    uint64_t nameOffsetsOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint64_t latitudesOffset;
+    uint64_t longitudesOffset;
+    uint64_t cityOffsetsOffset;
+    uint64_t citiesOffset;
+    uint64_t citiesSize;
+};
+
+// Binary columnar hotel file, mapped and read in place without parsing
+class HotelStore {
+public:
+    static const uint32_t VERSION = 2;
+
+    bool open(const string& path);      // false if missing, truncated or of another version
+    void close() { file.close(); header = nullptr; }
+    bool isOpen() const { return header != nullptr; }
+
+    size_t size() const { return header ? header->count : 0; }
+    int id(size_t i) const { return ids[i]; }
+    int price(size_t i) const { return prices[i]; }
+    float rating(size_t i) const { return ratings[i]; }
+    float distance(size_t i) const { return distances[i]; }
+    string_view name(size_t i) const { return string_view(names + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]); }
+    HotelLocation location(size_t i) const {
+        return {latitudes[i], longitudes[i], string_view(cities + cityOffsets[i], cityOffsets[i + 1] - cityOffsets[i])};
+    }
+
+    // Whole columns, valid while the store stays open
+    const int32_t* idColumn() const { return ids; }
+    const int32_t* priceColumn() const { return prices; }
+    const float* ratingColumn() const { return ratings; }
+    const float* distanceColumn() const { return distances; }
+    const float* latitudeColumn() const { return latitudes; }
+    const float* longitudeColumn() const { return longitudes; }
+
+    // Writes through a synced temporary file and renames it, so readers never see a partial file
+    static bool write(const string& path, const HotelColumns& columns);
+
+private:
+    MappedFile file;
+    const HotelFileHeader* header = nullptr;
+    const int32_t* ids = nullptr;
+    const int32_t* prices = nullptr;
+    const float* ratings = nullptr;
+    const float* distances = nullptr;
+    const uint32_t* nameOffsets = nullptr;
+    const char* names = nullptr;
+    const float* latitudes = nullptr;
+    const float* longitudes = nullptr;
+    const uint32_t* cityOffsets = nullptr;
+    const char* cities = nullptr;
+};
+
+// Legacy information.txt: one "id name price rating distance [latitude longitude [city]]" record
+// per line, the location being optional. Malformed lines are skipped. Cities are lowercased, as
+// HotelManager stores them.
+bool readLegacyHotels(const string& path, HotelColumns& out);
+
+// One-shot conversion of a legacy text file into the binary format
+bool convertLegacyHotels(const string& textPath, const string& binaryPath);
+
+#endif // HOTELSTORE_H
@@ -0,0 +1,274 @@
+#include "hoteltable.h"
+#include <algorithm>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Returns the match mask of rows [row, row + 64) (fewer at the end of the table)
+uint64_t filterWord(const HotelTable& table, const HotelFilter& f, size_t row)
+{
+    const int32_t* price = table.priceRun(row);
+    const float* rating = table.ratingRun(row);
+    const float* distance = table.distanceRun(row);
+    size_t count = min<size_t>(64, table.size() - row);
+    uint64_t word = 0;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    if (count == 64) {
+        // Inclusive int bounds as exclusive compares: minPrice - 1 < p < maxPrice + 1, saturated
+        __m256i priceLo = _mm256_set1_epi32(f.minPrice == INT_MIN ? INT_MIN : f.minPrice - 1);
+        __m256i priceHi = _mm256_set1_epi32(f.maxPrice == INT_MAX ? INT_MAX : f.maxPrice + 1);
+        __m256 ratingLo = _mm256_set1_ps(f.minRating), ratingHi = _mm256_set1_ps(f.maxRating);
+        __m256 distLo = _mm256_set1_ps(f.minDistance), distHi = _mm256_set1_ps(f.maxDistance);
+        bool unboundedLo = f.minPrice == INT_MIN, unboundedHi = f.maxPrice == INT_MAX;
+        __m256i all = _mm256_set1_epi32(-1);
+        for (; i < 64; i += 8) {
+            __m256i p = _mm256_loadu_si256((const __m256i*)(price + i));
+            __m256i okLo = unboundedLo ? all : _mm256_cmpgt_epi32(p, priceLo);
+            __m256i okHi = unboundedHi ? all : _mm256_cmpgt_epi32(priceHi, p);
+            __m256 r = _mm256_loadu_ps(rating + i);
+            __m256 d = _mm256_loadu_ps(distance + i);
+            __m256 ok = _mm256_and_ps(_mm256_castsi256_ps(_mm256_and_si256(okLo, okHi)),
+                                      _mm256_and_ps(_mm256_cmp_ps(r, ratingLo, _CMP_GE_OQ), _mm256_cmp_ps(r, ratingHi, _CMP_LE_OQ)));
+            ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(d, distLo, _CMP_GE_OQ), _mm256_cmp_ps(d, distHi, _CMP_LE_OQ)));
+            word |= (uint64_t)_mm256_movemask_ps(ok) << i;
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    if (count == 64) {
+        __m128i priceLo = _mm_set1_epi32(f.minPrice == INT_MIN ? INT_MIN : f.minPrice - 1);
+        __m128i priceHi = _mm_set1_epi32(f.maxPrice == INT_MAX ? INT_MAX : f.maxPrice + 1);
+        __m128 ratingLo = _mm_set1_ps(f.minRating), ratingHi = _mm_set1_ps(f.maxRating);
+        __m128 distLo = _mm_set1_ps(f.minDistance), distHi = _mm_set1_ps(f.maxDistance);
+        bool unboundedLo = f.minPrice == INT_MIN, unboundedHi = f.maxPrice == INT_MAX;
+        __m128i all = _mm_set1_epi32(-1);
+        for (; i < 64; i += 4) {
+            __m128i p = _mm_loadu_si128((const __m128i*)(price + i));
+            __m128i okLo = unboundedLo ? all : _mm_cmpgt_epi32(p, priceLo);
+            __m128i okHi = unboundedHi ? all : _mm_cmpgt_epi32(priceHi, p);
+            __m128 r = _mm_loadu_ps(rating + i);
+            __m128 d = _mm_loadu_ps(distance + i);
+            __m128 ok = _mm_and_ps(_mm_castsi128_ps(_mm_and_si128(okLo, okHi)),
+                                   _mm_and_ps(_mm_cmpge_ps(r, ratingLo), _mm_cmple_ps(r, ratingHi)));
+            ok = _mm_and_ps(ok, _mm_and_ps(_mm_cmpge_ps(d, distLo), _mm_cmple_ps(d, distHi)));
+            word |= (uint64_t)_mm_movemask_ps(ok) << i;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        if (f.matches(price[i], rating[i], distance[i])) word |= uint64_t(1) << i;
+    }
+    return word;
+}
+
+} // namespace
+
+uint32_t NamePool::intern(string_view name)
+{
+    if ((names.size() + 1) * 2 > buckets.size()) grow();
+
+    uint64_t code = std::hash<string_view>()(name);
+    size_t slot = probe(name, code);
+    if (buckets[slot]) return (uint32_t)buckets[slot] - 1;
+
+    uint32_t id = names.size();
+    names.push_back(string(name));
+    buckets.set(slot, (code & 0xFFFFFFFF00000000ull) | (id + 1));
+    return id;
+}
+
+uint32_t NamePool::find(string_view name) const
+{
+    if (buckets.size() == 0) return NONE;
+    size_t slot = probe(name, std::hash<string_view>()(name));
+    return buckets[slot] ? (uint32_t)buckets[slot] - 1 : NONE;
+}
+
+size_t NamePool::probe(string_view name, uint64_t code) const
+{
+    size_t mask = buckets.size() - 1;
+    uint64_t tag = code & 0xFFFFFFFF00000000ull;
+    for (size_t slot = code & mask; ; slot = (slot + 1) & mask) {
+        uint64_t entry = buckets[slot];
+        if (!entry) return slot;
+        // Compare the stored hash bits before touching the string
+        if ((entry & 0xFFFFFFFF00000000ull) == tag && names[(uint32_t)entry - 1] == name) return slot;
+    }
+}
+
+void NamePool::grow()
+{
+    size_t capacity = max<size_t>(16, buckets.size() * 2);
+    vector<uint64_t> slots(capacity, 0);
+    size_t mask = capacity - 1;
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        uint64_t code = std::hash<string_view>()(names[id]);
+        size_t slot = code & mask;
+        while (slots[slot]) slot = (slot + 1) & mask;
+        slots[slot] = (code & 0xFFFFFFFF00000000ull) | (id + 1);
+    }
+    buckets.assign(slots.data(), capacity);
+}
+
+void NamePool::clear()
+{
+    names.clear();
+    buckets.clear();
+}
+
+void HotelTable::clear()
+{
+    ids.clear();
+    prices.clear();
+    ratings.clear();
+    distances.clear();
+    nameIds.clear();
+    latitudes.clear();
+    longitudes.clear();
+    cityIds.clear();
+    pool = make_shared<NamePool>();
+    cityPool = make_shared<NamePool>();
+    removed.clear();
+    removedCount = 0;
+    rowOfId.clear();
+    sparseRowOfId.clear();
+    highestId = 0;
+}
+
+void HotelTable::reserve(size_t n)
+{
+    ids.reserve(n);
+    prices.reserve(n);
+    ratings.reserve(n);
+    distances.reserve(n);
+    nameIds.reserve(n);
+    latitudes.reserve(n);
+    longitudes.reserve(n);
+    cityIds.reserve(n);
+}
+
+size_t HotelTable::append(int id, string_view name, int price, float rating, float distance, const HotelLocation& location)
+{
+    ids.push_back(id);
+    prices.push_back(price);
+    ratings.push_back(rating);
+    distances.push_back(distance);
+    nameIds.push_back(intern(pool, name));
+    latitudes.push_back(location.latitude);
+    longitudes.push_back(location.longitude);
+    cityIds.push_back(location.city.empty() ? NamePool::NONE : intern(cityPool, location.city));
+    indexId(id, ids.size() - 1);
+    return ids.size() - 1;
+}
+
+void HotelTable::update(size_t row, string_view name, int price, float rating, float distance, const HotelLocation& location)
+{
+    // Unchanged fields are skipped, so their chunks stay shared with published copies
+    if (prices[row] != price) prices.set(row, price);
+    if (ratings[row] != rating) ratings.set(row, rating);
+    if (distances[row] != distance) distances.set(row, distance);
+    uint32_t nameId = intern(pool, name);
+    if (nameIds[row] != nameId) nameIds.set(row, nameId);
+    if (latitudes[row] != location.latitude) latitudes.set(row, location.latitude);
+    if (longitudes[row] != location.longitude) longitudes.set(row, location.longitude);
+    uint32_t cityId = location.city.empty() ? NamePool::NONE : intern(cityPool, location.city);
+    if (cityIds[row] != cityId) cityIds.set(row, cityId);
+}
+
+void HotelTable::remove(size_t row)
+{
+    if (!isLive(row)) return;
+    if (removed.size() < (ids.size() + 63) / 64) removed.resize((ids.size() + 63) / 64);
+    removed.set(row / 64, removed[row / 64] | uint64_t(1) << (row % 64));
+    removedCount++;
+
+    // An ID stored sparse stays there after rowOfId grows past it, so check both
+    int id = ids[row];
+    if (id >= 0 && (size_t)id < rowOfId.size() && rowOfId[id] == row) rowOfId.set(id, UINT32_MAX);
+    auto it = sparseRowOfId.find(id);
+    if (it != sparseRowOfId.end() && it->second == row) sparseRowOfId.erase(it);
+}
+
+NamePool& HotelTable::writable(shared_ptr<NamePool>& shared)
+{
+    // Copies of this table (published snapshots) only ever read their pools
+    if (shared.use_count() > 1) shared = make_shared<NamePool>(*shared);
+    return *shared;
+}
+
+uint32_t HotelTable::intern(shared_ptr<NamePool>& shared, string_view name)
+{
+    uint32_t id = shared->find(name);
+    return id != NamePool::NONE ? id : writable(shared).intern(name);
+}
+
+void HotelTable::indexId(int id, size_t row)
+{
+    if (id > highestId) highestId = id;
+    if (id >= 0 && (size_t)id <= 2 * ids.size() + 1024) {
+        if ((size_t)id >= rowOfId.size()) rowOfId.resize(max((size_t)id + 1, rowOfId.size() * 2), UINT32_MAX);
+        if (rowOfId[id] == UINT32_MAX && (sparseRowOfId.empty() || !sparseRowOfId.count(id))) rowOfId.set(id, row);
+    } else {
+        sparseRowOfId.emplace(id, row);     // Keeps the first row for a repeated ID
+    }
+}
+
+size_t HotelTable::findId(int id) const
+{
+    if (id >= 0 && (size_t)id < rowOfId.size() && rowOfId[id] != UINT32_MAX) return rowOfId[id];
+    if (sparseRowOfId.empty()) return NONE;
+    auto it = sparseRowOfId.find(id);
+    return it == sparseRowOfId.end() ? NONE : it->second;
+}
+
+void HotelTable::loadFrom(const HotelStore& store)
+{
+    clear();
+    size_t n = store.size();
+    ids.assign(store.idColumn(), n);
+    prices.assign(store.priceColumn(), n);
+    ratings.assign(store.ratingColumn(), n);
+    distances.assign(store.distanceColumn(), n);
+    latitudes.assign(store.latitudeColumn(), n);
+    longitudes.assign(store.longitudeColumn(), n);
+    nameIds.reserve(n);
+    cityIds.reserve(n);
+    NamePool& names = writable(pool);
+    NamePool& cityNames = writable(cityPool);
+    for (size_t i = 0; i < n; ++i) {
+        nameIds.push_back(names.intern(store.name(i)));
+        string_view city = store.location(i).city;
+        cityIds.push_back(city.empty() ? NamePool::NONE : cityNames.intern(city));
+        indexId(ids[i], i);
+    }
+}
+
+void filterHotels(const HotelTable& table, const HotelFilter& filter, vector<uint64_t>& bitmap)
+{
+    size_t words = (table.size() + 63) / 64;
+    bitmap.resize(words);
+    for (size_t w = 0; w < words; ++w) bitmap[w] = filterWord(table, filter, w * 64) & table.liveMask(w);
+}
+
+void filterHotels(const HotelTable& table, const HotelFilter& filter, vector<uint32_t>& rows)
+{
+    rows.clear();
+    for (size_t row = 0; row < table.size(); row += 64) {
+        for (uint64_t word = filterWord(table, filter, row) & table.liveMask(row / 64); word; word &= word - 1) {
+            rows.push_back(row + lowestBit(word));
+        }
+    }
+}
+
+void bitmapToRows(const vector<uint64_t>& bitmap, vector<uint32_t>& rows)
+{
+    rows.clear();
+    for (size_t w = 0; w < bitmap.size(); ++w) {
+        for (uint64_t word = bitmap[w]; word; word &= word - 1) {
+            rows.push_back(w * 64 + lowestBit(word));
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#ifndef HOTELTABLE_H
+#define HOTELTABLE_H
+
+#include <cstdint>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bitops.h"
+#include "hotelstore.h"
+using namespace std;
+
+// Column of values split into fixed-size chunks that copies share: a copy costs one pointer per
+// chunk, and a write copies only the chunk it lands in, and only while another copy still holds it.
+// Chunks hold a multiple of 64 values, so a 64-row word of a selection bitmap never straddles two.
+template <typename T>
+class ChunkedColumn {
+public:
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK = size_t(1) << CHUNK_BITS;
+
+    size_t size() const { return count; }
+    const T& operator[](size_t i) const { return chunks[i >> CHUNK_BITS]->values[i & (CHUNK - 1)]; }
+    const T* run(size_t i) const { return chunks[i >> CHUNK_BITS]->values + (i & (CHUNK - 1)); }   // Contiguous to its chunk's end
+
+    void set(size_t i, T value) { writable(i >> CHUNK_BITS).values[i & (CHUNK - 1)] = move(value); }
+    void push_back(T value)
+    {
+        if ((count & (CHUNK - 1)) == 0) chunks.push_back(make_shared<Chunk>());
+        writable(chunks.size() - 1).values[count & (CHUNK - 1)] = move(value);
+        count++;
+    }
+    void resize(size_t n, T fill = T())
+    {
+        while (count < n && (count & (CHUNK - 1))) push_back(fill);
+        chunks.resize((n + CHUNK - 1) >> CHUNK_BITS);
+        for (size_t c = (count + CHUNK - 1) >> CHUNK_BITS; c < chunks.size(); ++c) {
+            chunks[c] = make_shared<Chunk>();
+            fill_n(chunks[c]->values, CHUNK, fill);
+        }
+        count = n;
+    }
+    void assign(const T* values, size_t n)
+    {
+        clear();
+        chunks.resize((n + CHUNK - 1) >> CHUNK_BITS);
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            chunks[c] = make_shared<Chunk>();
+            copy_n(values + (c << CHUNK_BITS), min(CHUNK, n - (c << CHUNK_BITS)), chunks[c]->values);
+        }
+        count = n;
+    }
+    void reserve(size_t n) { chunks.reserve((n + CHUNK - 1) >> CHUNK_BITS); }
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+
+private:
+    struct Chunk {
+        T values[CHUNK];
+    };
+    vector<shared_ptr<Chunk>> chunks;
+    size_t count = 0;
+
+    // Copies of a table (published snapshots) are only read, so a count of one stays one
+    Chunk& writable(size_t c)
+    {
+        if (chunks[c].use_count() > 1) chunks[c] = make_shared<Chunk>(*chunks[c]);
+        return *chunks[c];
+    }
+};
+
+// Deduplicated hotel names; ids are dense and stable for the pool's lifetime.
+// Lookup is an open-addressing table with linear probing, at most half full. Names and slots sit in
+// chunked columns, so a copy shares them and an intern copies only the chunks it writes.
+class NamePool {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t intern(string_view name);
+    uint32_t find(string_view name) const;      // NONE if the name was never interned
+    const string& name(uint32_t id) const { return names[id]; }    // Valid until the next intern
+    size_t size() const { return names.size(); }
+    void clear();
+
+private:
+    ChunkedColumn<string> names;
+    ChunkedColumn<uint64_t> buckets;    // (hash high bits << 32) | (id + 1); 0 marks an empty slot
+
+    size_t probe(string_view name, uint64_t code) const;   // Slot holding name, or the empty slot to fill
+    void grow();
+};
+
+// Hotel records as separate columns, so scans only touch the attributes they test. Columns are
+// chunked, so a copy (a published snapshot) shares them and a later edit copies only what it touches.
+// Removed rows keep their slot, so row numbers stay stable; filterHotels skips them.
+class HotelTable {
+public:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    size_t size() const { return ids.size(); }                  // Rows, including removed ones
+    size_t liveCount() const { return ids.size() - removedCount; }
+    bool empty() const { return liveCount() == 0; }
+    void clear();
+    void reserve(size_t n);
+
+    // Returns the row
+    size_t append(int id, string_view name, int price, float rating, float distance,
+                  const HotelLocation& location = HotelLocation());
+    void update(size_t row, string_view name, int price, float rating, float distance,
+                const HotelLocation& location = HotelLocation());
+    void remove(size_t row);
+    void loadFrom(const HotelStore& store);
+
+    bool isLive(size_t row) const { return liveMask(row / 64) >> (row % 64) & 1; }
+    uint64_t liveMask(size_t word) const { return word < removed.size() ? ~removed[word] : ~uint64_t(0); }
+
+    // Row holding a live hotel with this ID (the first one if the file repeats it), or NONE
+    size_t findId(int id) const;
+    int maxId() const { return highestId; }         // Largest ID ever appended, 0 for an empty table
+
+    int id(size_t row) const { return ids[row]; }
+    const string& name(size_t row) const { return pool->name(nameIds[row]); }
+    int price(size_t row) const { return prices[row]; }
+    float rating(size_t row) const { return ratings[row]; }
+    float distance(size_t row) const { return distances[row]; }
+    float latitude(size_t row) const { return latitudes[row]; }
+    float longitude(size_t row) const { return longitudes[row]; }
+    uint32_t cityId(size_t row) const { return cityIds[row]; }     // NamePool::NONE when not attached
+    string_view city(size_t row) const { return cityIds[row] == NamePool::NONE ? string_view() : cityPool->name(cityIds[row]); }
+    HotelLocation location(size_t row) const { return {latitudes[row], longitudes[row], city(row)}; }
+
+    uint32_t nameId(size_t row) const { return nameIds[row]; }
+
+    // Columns from row on, contiguous to the end of row's chunk (at least to the next multiple of 64)
+    const int32_t* priceRun(size_t row) const { return prices.run(row); }
+    const float* ratingRun(size_t row) const { return ratings.run(row); }
+    const float* distanceRun(size_t row) const { return distances.run(row); }
+    const NamePool& names() const { return *pool; }
+    const NamePool& cities() const { return *cityPool; }
+
+private:
+    ChunkedColumn<int32_t> ids;
+    ChunkedColumn<int32_t> prices;
+    ChunkedColumn<float> ratings;
+    ChunkedColumn<float> distances;
+    ChunkedColumn<uint32_t> nameIds;
+    ChunkedColumn<float> latitudes;
+    ChunkedColumn<float> longitudes;
+    ChunkedColumn<uint32_t> cityIds;
+    shared_ptr<NamePool> pool = make_shared<NamePool>();   // Shared between copies until one interns a name
+    shared_ptr<NamePool> cityPool = make_shared<NamePool>();
+
+    static NamePool& writable(shared_ptr<NamePool>& shared);
+    static uint32_t intern(shared_ptr<NamePool>& shared, string_view name);
+
+    ChunkedColumn<uint64_t> removed;    // Bitmap of removed rows, grown on first removal
+    size_t removedCount = 0;
+
+    // ID -> row. IDs up to about twice the row count live in a dense array, any others in a map
+    ChunkedColumn<uint32_t> rowOfId;
+    unordered_map<int, uint32_t> sparseRowOfId;
+    int highestId = 0;
+
+    void indexId(int id, size_t row);
+};
+
+// Inclusive range predicate over price, rating and distance; the defaults accept everything
+struct HotelFilter {
+    int minPrice = INT_MIN;
+    int maxPrice = INT_MAX;
+    float minRating = -INFINITY;
+    float maxRating = INFINITY;
+    float minDistance = -INFINITY;
+    float maxDistance = INFINITY;
+
+    bool matches(int price, float rating, float distance) const {
+        return price >= minPrice && price <= maxPrice && rating >= minRating && rating <= maxRating
+               && distance >= minDistance && distance <= maxDistance;
+    }
+};
+
+// Selection bitmap: bit (row % 64) of word (row / 64) is set for matching rows.
+// Uses AVX2 or SSE2 when the build targets them, with a scalar fallback.
+void filterHotels(const HotelTable& table, const HotelFilter& filter, vector<uint64_t>& bitmap);
+
+// Matching rows in ascending order
+void filterHotels(const HotelTable& table, const HotelFilter& filter, vector<uint32_t>& rows);
+
+// Rows whose bits are set, in ascending order
+void bitmapToRows(const vector<uint64_t>& bitmap, vector<uint32_t>& rows);
+
+#endif // HOTELTABLE_H
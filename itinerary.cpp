@@ -0,0 +1,264 @@
+#include "itinerary.h"
+#include "asyncjob.h"
+#include "bitops.h"
+#include "graphcore.h"
+#include "metrics.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+// Fewer stops than this fill the Held-Karp table on one thread
+const int PARALLEL_STOPS = 12;
+
+// Moves must save at least this much to count, so rounding cannot make the search cycle
+const double MIN_GAIN = 1e-3;
+
+// Bits of a subset of stops other than j, with bit j squeezed out, and back
+inline uint32_t pack(uint32_t set, int j) { return (set & ((1u << j) - 1)) | ((set >> (j + 1)) << j); }
+inline uint32_t unpack(uint32_t packed, int j) { return (packed & ((1u << j) - 1)) | ((packed >> j) << (j + 1)); }
+
+// Next larger number with the same count of set bits (Gosper's hack)
+inline uint32_t nextSubset(uint32_t set)
+{
+    uint32_t low = set & (~set + 1), ripple = set + low;
+    return ripple | (((ripple ^ set) >> 2) / low);
+}
+
+bool heldKarp(const vector<float>& dist, int n, bool closed, vector<int>& order, float& length,
+              ThreadPool* pool, JobControl* job)
+{
+    int m = n - 1;
+    size_t width = (size_t)1 << (m - 1);
+    auto leg = [&](int a, int b) { return dist[(size_t)a * n + b]; };
+
+    // cost[j * width + pack(S, j)]: shortest walk from the start through the stops of S, then stop j.
+    // Stops are numbered from 0 here, place j + 1 in dist.
+    vector<float> cost(m * width, GraphCore::INF);
+    vector<uint8_t> parent(m * width, 0);
+    METRIC_ADD(BufferAllocations, 2);
+
+    // Layer k holds the subsets of k stops; each end stop's row reads only layer k - 1 of the others
+    for (int k = 0; k < m; ++k) {
+        auto fillRow = [&](int j) {
+            float* row = cost.data() + j * width;
+            uint8_t* via = parent.data() + j * width;
+            if (k == 0) {
+                row[0] = leg(0, j + 1);
+                return;
+            }
+            for (uint32_t packed = (1u << k) - 1; packed < width; packed = nextSubset(packed)) {
+                uint32_t set = unpack(packed, j);
+                int best = -1;
+                for (uint32_t rest = set; rest; rest &= rest - 1) {
+                    int i = lowestBit(rest);
+                    float total = cost[i * width + pack(set & ~(1u << i), i)] + leg(i + 1, j + 1);
+                    if (best < 0 || total < row[packed]) {
+                        row[packed] = total;
+                        best = i;
+                    }
+                }
+                via[packed] = (uint8_t)best;
+            }
+        };
+        if (pool && m >= PARALLEL_STOPS) pool->parallelFor(m, fillRow);
+        else for (int j = 0; j < m; ++j) fillRow(j);
+
+        if (job) {
+            if (job->isCancelled()) return false;
+            job->progress(k + 1, m);
+        }
+    }
+    METRIC_ADD(DpCells, m * width);
+
+    uint32_t everyOther = (uint32_t)width - 1;
+    int last = 0;
+    for (int j = 0; j < m; ++j) {
+        float total = cost[j * width + everyOther] + (closed ? leg(j + 1, 0) : 0);
+        if (j == 0 || total < length) {
+            length = total;
+            last = j;
+        }
+    }
+
+    order.clear();
+    uint32_t set = ((1u << m) - 1) & ~(1u << last);
+    for (int j = last;;) {
+        order.push_back(j + 1);
+        if (!set) break;
+        int i = parent[j * width + pack(set, j)];
+        set &= ~(1u << i);
+        j = i;
+    }
+    reverse(order.begin(), order.end());
+    return true;
+}
+
+// Local search over tours laid out as start, stops..., END, where END stands for the way home on
+// a round trip and costs nothing otherwise. Both ends stay put; moves only rearrange the stops.
+class TourSearch {
+public:
+    TourSearch(const vector<float>& dist, int n, bool closed, Clock::time_point deadline, JobControl* job)
+        : dist(dist), n(n), closed(closed), deadline(deadline), job(job) {}
+
+    int end() const { return n; }
+
+    double leg(int a, int b) const
+    {
+        if (b == n) return closed ? dist[(size_t)a * n] : 0;
+        return dist[(size_t)a * n + b];
+    }
+
+    double length(const vector<int>& tour) const
+    {
+        double total = 0;
+        for (size_t i = 0; i + 1 < tour.size(); ++i) total += leg(tour[i], tour[i + 1]);
+        return total;
+    }
+
+    bool spent() const { return Clock::now() >= deadline || (job && job->isCancelled()); }
+
+    // Greedy start: always on to the closest stop not yet visited
+    void nearestNeighbour(vector<int>& tour) const
+    {
+        vector<bool> visited(n, false);
+        tour.assign(1, 0);
+        for (int step = 1; step < n; ++step) {
+            int at = tour.back(), next = -1;
+            for (int stop = 1; stop < n; ++stop) {
+                if (!visited[stop] && (next < 0 || leg(at, stop) < leg(at, next))) next = stop;
+            }
+            visited[next] = true;
+            tour.push_back(next);
+        }
+        tour.push_back(end());
+    }
+
+    // Applies improving moves until none is left or time runs out
+    void improve(vector<int>& tour) const
+    {
+        while (!spent()) {
+            bool reversed = twoOpt(tour);
+            bool moved = orOpt(tour);
+            if (!reversed && !moved) return;
+        }
+    }
+
+    // Swaps two neighbouring stretches of stops, a move the local search cannot undo in one step
+    void kick(vector<int>& tour, mt19937& random) const
+    {
+        int stops = (int)tour.size() - 2;
+        int cut[3];
+        uniform_int_distribution<int> position(1, stops + 1);
+        do {
+            for (int& c : cut) c = position(random);
+            sort(cut, cut + 3);
+        } while (cut[0] == cut[1] || cut[1] == cut[2]);
+        rotate(tour.begin() + cut[0], tour.begin() + cut[1], tour.begin() + cut[2]);
+    }
+
+private:
+    const vector<float>& dist;
+    int n;
+    bool closed;
+    Clock::time_point deadline;
+    JobControl* job;
+
+    // Reverses tour[i..k] wherever that shortens the two legs it replaces
+    bool twoOpt(vector<int>& tour) const
+    {
+        int last = (int)tour.size() - 2;
+        bool improved = false;
+        for (int i = 1; i < last && !spent(); ++i) {
+            for (int k = i + 1; k <= last; ++k) {
+                double delta = leg(tour[i - 1], tour[k]) + leg(tour[i], tour[k + 1])
+                               - leg(tour[i - 1], tour[i]) - leg(tour[k], tour[k + 1]);
+                if (delta < -MIN_GAIN) {
+                    reverse(tour.begin() + i, tour.begin() + k + 1);
+                    improved = true;
+                }
+            }
+        }
+        return improved;
+    }
+
+    // Moves runs of one to three stops elsewhere in the tour, either way round
+    bool orOpt(vector<int>& tour) const
+    {
+        int last = (int)tour.size() - 2;
+        bool improved = false;
+        for (int size = 1; size <= 3; ++size) {
+            for (int i = 1; i + size - 1 <= last && !spent(); ++i) {
+                int first = tour[i], tail = tour[i + size - 1];
+                double saved = leg(tour[i - 1], first) + leg(tail, tour[i + size]) - leg(tour[i - 1], tour[i + size]);
+                for (int p = 0; p <= last; ++p) {
+                    if (p >= i - 1 && p <= i + size - 1) continue;
+                    double forward = leg(tour[p], first) + leg(tail, tour[p + 1]) - leg(tour[p], tour[p + 1]);
+                    double backward = leg(tour[p], tail) + leg(first, tour[p + 1]) - leg(tour[p], tour[p + 1]);
+                    if (min(forward, backward) >= saved - MIN_GAIN) continue;
+
+                    // Insert between tour[p] and tour[p + 1]
+                    int at;
+                    if (p < i) {
+                        rotate(tour.begin() + p + 1, tour.begin() + i, tour.begin() + i + size);
+                        at = p + 1;
+                    } else {
+                        rotate(tour.begin() + i, tour.begin() + i + size, tour.begin() + p + 1);
+                        at = p - size + 1;
+                    }
+                    if (backward < forward) reverse(tour.begin() + at, tour.begin() + at + size);
+                    improved = true;
+                    break;
+                }
+            }
+        }
+        return improved;
+    }
+};
+
+bool localSearch(const vector<float>& dist, int n, const ItineraryOptions& options, vector<int>& order,
+                 float& length, JobControl* job)
+{
+    TourSearch search(dist, n, options.returnToStart, Clock::now() + options.budget, job);
+    vector<int> best;
+    search.nearestNeighbour(best);
+    search.improve(best);
+    double bestLength = search.length(best);
+
+    // Iterated local search: kick the best tour found and keep the result if it is shorter.
+    // A fixed seed plans the same tour for the same input, time permitting.
+    mt19937 random(n);
+    vector<int> trial;
+    while (n > 4 && !search.spent()) {
+        trial = best;
+        search.kick(trial, random);
+        search.improve(trial);
+        double trialLength = search.length(trial);
+        if (trialLength < bestLength - MIN_GAIN) {
+            best.swap(trial);
+            bestLength = trialLength;
+        }
+    }
+    if (job && job->isCancelled()) return false;
+
+    order.assign(best.begin() + 1, best.end() - 1);
+    length = (float)bestLength;
+    return true;
+}
+
+} // namespace
+
+bool planTour(const vector<float>& dist, int n, const ItineraryOptions& options, vector<int>& order,
+              float& length, bool& exact, ThreadPool* pool, JobControl* job)
+{
+    order.clear();
+    length = 0;
+    exact = true;
+    if (n <= 1) return true;
+
+    exact = n - 1 <= min(options.exactLimit, MAX_EXACT_STOPS);
+    if (exact) return heldKarp(dist, n, options.returnToStart, order, length, pool, job);
+    return localSearch(dist, n, options, order, length, job);
+}
@@ -0,0 +1,34 @@
+#ifndef ITINERARY_H
+#define ITINERARY_H
+
+#include <chrono>
+#include <vector>
+#include "threadpool.h"
+using namespace std;
+
+class JobControl;
+
+struct ItineraryOptions {
+    bool returnToStart = false;         // Round trip: the last stop leads back to the start
+    int exactLimit = 16;                // Held-Karp up to this many stops (at most MAX_EXACT_STOPS)
+    chrono::milliseconds budget{200};   // Time for the whole local search, improving the first tour included
+};
+
+// Stops beyond this would need a DP table of several hundred MB
+const int MAX_EXACT_STOPS = 20;
+
+// Orders the stops of a tour over n places with the least total distance. dist is n x n row-major,
+// place 0 is the start and places 1..n-1 the stops; order receives the stops in visiting order.
+//
+// Up to options.exactLimit stops the answer is exact: Held-Karp over subsets of stops, with the
+// table packed to drop the bit of each subset's last stop and each layer of equal-sized subsets
+// spread over the pool. Beyond that a nearest-neighbour tour is improved by 2-opt and Or-opt
+// moves, then perturbed and re-improved until the budget runs out; a budget too short to finish
+// improving the first tour returns it part-improved. Both assume dist symmetric, as
+// Graph roads are; the returned length is measured on dist either way.
+//
+// length is INF or more when some leg is unreachable. Returns false if job was cancelled.
+bool planTour(const vector<float>& dist, int n, const ItineraryOptions& options, vector<int>& order,
+              float& length, bool& exact, ThreadPool* pool = &ThreadPool::shared(), JobControl* job = nullptr);
+
+#endif // ITINERARY_H
@@ -1,17 +1,20 @@
-QT += core widgets
-
-CONFIG += c++17
-
-TARGET = SmartTravel
-TEMPLATE = app
-
-SOURCES += \
-    main.cpp \
-    mainwindow.cpp
-
-HEADERS += \
-    mainwindow.h \
-    management.h
-
-FORMS += \
-    ../mainWindow.ui
+QT += core widgets
+
+CONFIG += c++17
+
+TARGET = SmartTravel
+TEMPLATE = app
+
+include(core.pri)
+
+SOURCES += \
+    main.cpp \
+    mainwindow.cpp \
+    hotellistmodel.cpp
+
+HEADERS += \
+    mainwindow.h \
+    hotellistmodel.h
+
+FORMS += \
+    ../mainWindow.ui
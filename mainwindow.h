@@ -1,40 +1,77 @@
-#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-#include <QMainWindow>
-#include <QMessageBox>
-#include <QInputDialog>
-#include <QString>
-#include "management.h"
-
-QT_BEGIN_NAMESPACE
-namespace Ui { class MainWindow; }
-QT_END_NAMESPACE
-
-class MainWindow : public QMainWindow {
-    Q_OBJECT
-
-public:
-    MainWindow(QWidget *parent = nullptr);
-    ~MainWindow();
-
-private slots:
-    void on_btnAddHotel_clicked();
-    void on_btnViewHotels_clicked();
-    void on_btnSortByPrice_clicked();
-    void on_btnSortByRating_clicked();
-    void on_btnSearchHotel_clicked();
-    void on_btnKnapsack_clicked();
-    void on_btnAddPath_clicked();
-    void on_btnDijkstra_clicked();
-    void on_btnSortByDistance_clicked();
-    void on_btnFloydWarshall_clicked();
-    void on_btnExit_clicked();
-
-private:
-    Ui::MainWindow *ui;
-    HotelManager hotelManager;
-    Graph graph;
-};
-
-#endif // MAINWINDOW_H
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QMessageBox>
+#include <QInputDialog>
+#include <QString>
+#include <QProgressDialog>
+#include <functional>
+#include <map>
+#include "management.h"
+#include "recommender.h"
+#include "hotellistmodel.h"
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class MainWindow; }
+QT_END_NAMESPACE
+
+class MainWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+signals:
+    // Emitted from worker threads; connected with Qt::QueuedConnection so the slots run on the GUI thread
+    void jobProgressed(int ticket, int percent);
+    void jobFinished(int ticket, const QString& result);
+
+private slots:
+    void on_btnAddHotel_clicked();
+    void on_btnViewHotels_clicked();
+    void on_btnSortByPrice_clicked();
+    void on_btnSortByRating_clicked();
+    void on_btnSearchHotel_clicked();
+    void on_btnKnapsack_clicked();
+    void on_btnAddPath_clicked();
+    void on_btnDijkstra_clicked();
+    void on_btnSortByDistance_clicked();
+    void on_btnFloydWarshall_clicked();
+    void on_btnImportRoads_clicked();
+    void on_btnBestValue_clicked();
+    void on_btnItinerary_clicked();
+    void on_btnExit_clicked();
+
+    void onJobProgressed(int ticket, int percent);
+    void onJobFinished(int ticket, const QString& result);
+
+private:
+    // A query running on the thread pool, with the dialog that shows its progress
+    struct BackgroundQuery {
+        QString title;
+        Job<QString> job;
+        QProgressDialog* dialog;
+        bool usesGraph;
+    };
+
+    Ui::MainWindow *ui;
+    HotelManager hotelManager;
+    Recommender recommender;
+    Graph graph;
+    string graphPath;                   // Snapshot of the road network, reloaded at startup
+    uint64_t savedGraphRevision = 0;    // graph.core.revision() as of the last load or save
+    map<int, BackgroundQuery> queries;
+    int nextTicket = 1;
+
+    // Runs work off the GUI thread and shows its result in a message box titled title.
+    // Graph queries run one at a time and edits wait for them, since they share the graph.
+    void runInBackground(const QString& title, bool usesGraph, function<QString(JobControl&)> work);
+    bool graphBusy();
+
+    // Modal table of every hotel, initially sorted by a HotelListModel column
+    void showHotelList(const QString& title, int column, Qt::SortOrder order, bool skylineOnly = false);
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,157 @@
+#include "metrics.h"
+#include "bitops.h"
+#include "hotellog.h"
+#include <cmath>
+#include <sstream>
+
+static const char* const OP_NAMES[(int)MetricOp::Count] = {
+    "graph.route", "graph.route_batch", "graph.floyd_warshall", "graph.itinerary", "hotel.knapsack",
+    "hotel.top_k", "hotel.skyline", "hotel.index_rebuild", "hotel.load", "hotel.checkpoint",
+    "hotel.log_append", "graph.import", "graph.load", "graph.save"
+};
+
+static const char* const COUNTER_NAMES[(int)MetricCounter::Count] = {
+    "nodes_settled", "dp_cells", "bytes_read", "bytes_written", "buffer_allocations"
+};
+
+static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+int LatencyHistogram::bucketOf(uint64_t value)
+{
+    if (value < (uint64_t)SUB_BUCKETS) return (int)value;
+    int top = highestBit(value);
+    int group = top - SUB_BITS + 1;
+    int sub = (int)((value >> (top - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return group * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::upperBound(int bucket)
+{
+    int group = bucket / SUB_BUCKETS;
+    if (group == 0) return (uint64_t)bucket;
+    int shift = group - 1;
+    uint64_t lower = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos)
+{
+    buckets[bucketOf(nanos)].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(1, memory_order_relaxed);
+    sumNanos.fetch_add(nanos, memory_order_relaxed);
+    uint64_t seen = maxNanos.load(memory_order_relaxed);
+    while (nanos > seen && !maxNanos.compare_exchange_weak(seen, nanos, memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : buckets) bucket.store(0, memory_order_relaxed);
+    total.store(0, memory_order_relaxed);
+    sumNanos.store(0, memory_order_relaxed);
+    maxNanos.store(0, memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = (uint64_t)ceil(fraction * (double)n);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i].load(memory_order_relaxed);
+        if (seen >= rank) return min(upperBound(i), max());
+    }
+    return max();
+}
+
+Metrics& Metrics::global()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::reset()
+{
+    for (auto& counter : counters) counter.store(0, memory_order_relaxed);
+    for (auto& histogram : histograms) histogram.reset();
+}
+
+string Metrics::toText() const
+{
+    ostringstream out;
+    out << "# TYPE smarttravel_op_seconds summary\n";
+    for (int op = 0; op < (int)MetricOp::Count; ++op) {
+        const LatencyHistogram& h = histograms[op];
+        string label = string("op=\"") + OP_NAMES[op] + "\"";
+        for (double q : QUANTILES) {
+            out << "smarttravel_op_seconds{" << label << ",quantile=\"" << q << "\"} "
+                << h.percentile(q) / 1e9 << '\n';
+        }
+        out << "smarttravel_op_seconds_sum{" << label << "} " << h.sum() / 1e9 << '\n';
+        out << "smarttravel_op_seconds_count{" << label << "} " << h.count() << '\n';
+    }
+    for (int c = 0; c < (int)MetricCounter::Count; ++c) {
+        out << "# TYPE smarttravel_" << COUNTER_NAMES[c] << "_total counter\n";
+        out << "smarttravel_" << COUNTER_NAMES[c] << "_total " << counter((MetricCounter)c) << '\n';
+    }
+    return out.str();
+}
+
+string Metrics::toJson() const
+{
+    ostringstream out;
+    out << "{\n  \"operations\": {";
+    for (int op = 0; op < (int)MetricOp::Count; ++op) {
+        const LatencyHistogram& h = histograms[op];
+        out << (op ? "," : "") << "\n    \"" << OP_NAMES[op] << "\": {\"count\": " << h.count()
+            << ", \"sum_ms\": " << h.sum() / 1e6 << ", \"max_ms\": " << h.max() / 1e6;
+        for (double q : QUANTILES) out << ", \"p" << q * 100 << "_ms\": " << h.percentile(q) / 1e6;
+        out << "}";
+    }
+    out << "\n  },\n  \"counters\": {";
+    for (int c = 0; c < (int)MetricCounter::Count; ++c) {
+        out << (c ? "," : "") << "\n    \"" << COUNTER_NAMES[c] << "\": " << counter((MetricCounter)c);
+    }
+    out << "\n  }\n}\n";
+    return out.str();
+}
+
+bool Metrics::dump(const string& path) const
+{
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    return replaceFileSynced(path, json ? toJson() : toText());
+}
+
+void Metrics::startDumping(const string& path, chrono::milliseconds period)
+{
+    stopDumping();
+    dumpStopping = false;
+    dumper = thread([this, path, period] {
+        unique_lock<mutex> lock(dumpLock);
+        while (!dumpWake.wait_for(lock, period, [this] { return dumpStopping; })) {
+            lock.unlock();
+            dump(path);
+            lock.lock();
+        }
+        lock.unlock();
+        dump(path);
+    });
+}
+
+void Metrics::stopDumping()
+{
+    if (!dumper.joinable()) return;
+    {
+        lock_guard<mutex> lock(dumpLock);
+        dumpStopping = true;
+    }
+    dumpWake.notify_all();
+    dumper.join();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+    Metrics::global().record(op, (uint64_t)elapsed.count());
+}
@@ -0,0 +1,126 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+using namespace std;
+
+// Timed operations, each with its own latency histogram
+enum class MetricOp {
+    Route,              // Graph::dijkstra / Graph::route
+    RouteBatch,
+    FloydWarshall,
+    Itinerary,
+    Knapsack,
+    TopK,               // Sorted and top-k hotel views
+    Skyline,
+    IndexRebuild,
+    HotelLoad,
+    HotelCheckpoint,
+    LogAppend,
+    GraphImport,
+    GraphLoad,
+    GraphSave,
+    Count
+};
+
+enum class MetricCounter {
+    NodesSettled,       // Cities taken off a search queue, over every graph search
+    DpCells,            // Floyd-Warshall relaxations, knapsack and itinerary table cells
+    BytesRead,          // Files mapped or read
+    BytesWritten,
+    BufferAllocations,  // Engine buffers allocated or regrown: search scratch, matrices, DP tables
+    Count
+};
+
+// Latency histogram with HDR-style buckets: values group by power of two and each group splits into
+// 16 linear sub-buckets, so a bucket is never wider than 1/16 of its lower bound. Recording is a few
+// relaxed atomic adds; any number of threads may record and read at once.
+class LatencyHistogram {
+public:
+    void record(uint64_t nanos);
+    void reset();
+
+    uint64_t count() const { return total.load(memory_order_relaxed); }
+    uint64_t sum() const { return sumNanos.load(memory_order_relaxed); }
+    uint64_t max() const { return maxNanos.load(memory_order_relaxed); }
+    uint64_t percentile(double fraction) const;    // Upper bound of the bucket holding it; 0 when empty
+
+private:
+    static const int SUB_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    atomic<uint64_t> buckets[BUCKETS] = {};
+    atomic<uint64_t> total{0};
+    atomic<uint64_t> sumNanos{0};
+    atomic<uint64_t> maxNanos{0};
+
+    static int bucketOf(uint64_t value);
+    static uint64_t upperBound(int bucket);
+};
+
+// Process-wide counters and histograms. Instrumented code goes through the METRIC_ macros below,
+// which compile to nothing when SMARTTRAVEL_NO_METRICS is defined (qmake CONFIG+=no_metrics).
+class Metrics {
+public:
+    static Metrics& global();
+    ~Metrics() { stopDumping(); }
+
+    void add(MetricCounter counter, uint64_t amount) { counters[(int)counter].fetch_add(amount, memory_order_relaxed); }
+    void record(MetricOp op, uint64_t nanos) { histograms[(int)op].record(nanos); }
+    uint64_t counter(MetricCounter counter) const { return counters[(int)counter].load(memory_order_relaxed); }
+    const LatencyHistogram& histogram(MetricOp op) const { return histograms[(int)op]; }
+    void reset();
+
+    // Prometheus text exposition (a summary per operation) or a JSON object of the same figures
+    string toText() const;
+    string toJson() const;
+
+    // Replaces path with the current figures: JSON when it ends in .json, text otherwise
+    bool dump(const string& path) const;
+
+    // Dumps to path every period from a background thread, and once more when stopped
+    void startDumping(const string& path, chrono::milliseconds period);
+    void stopDumping();
+
+private:
+    atomic<uint64_t> counters[(int)MetricCounter::Count] = {};
+    LatencyHistogram histograms[(int)MetricOp::Count];
+
+    thread dumper;
+    mutex dumpLock;
+    condition_variable dumpWake;
+    bool dumpStopping = false;
+};
+
+// Records the lifetime of a scope into an operation's histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(MetricOp op) : op(op), start(chrono::steady_clock::now()) {}
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    MetricOp op;
+    chrono::steady_clock::time_point start;
+};
+
+#define METRIC_CONCAT_(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_(a, b)
+
+#ifdef SMARTTRAVEL_NO_METRICS
+#define METRIC_TIMER(op) ((void)0)
+#define METRIC_ADD(counter, amount) ((void)0)
+#else
+#define METRIC_TIMER(op) ScopedTimer METRIC_CONCAT(metricTimer, __LINE__)(MetricOp::op)
+#define METRIC_ADD(counter, amount) Metrics::global().add(MetricCounter::counter, (amount))
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,273 @@
+#include "nameindex.h"
+#include <algorithm>
+
+namespace {
+
+const char PAD_FRONT = '\x01';
+const char PAD_BACK = '\x02';
+
+// Distinct trigrams of "\1\1" + text + "\2\2", sorted
+void trigrams(string_view text, vector<uint32_t>& grams)
+{
+    string padded;
+    padded.reserve(text.size() + 4);
+    padded.append(2, PAD_FRONT).append(text).append(2, PAD_BACK);
+
+    grams.clear();
+    for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+        grams.push_back((uint32_t)(unsigned char)padded[i] << 16 | (uint32_t)(unsigned char)padded[i + 1] << 8
+                        | (unsigned char)padded[i + 2]);
+    }
+    sort(grams.begin(), grams.end());
+    grams.erase(unique(grams.begin(), grams.end()), grams.end());
+}
+
+bool startsWith(string_view text, string_view prefix)
+{
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+int boundedEditDistance(string_view a, string_view b, int maxEdits)
+{
+    int n = a.size(), m = b.size();
+    if (abs(n - m) > maxEdits) return maxEdits + 1;
+
+    // Only cells with |i - j| <= maxEdits can stay within budget
+    const int over = maxEdits + 1;
+    vector<int> prev(m + 1), curr(m + 1);
+    for (int j = 0; j <= m; ++j) prev[j] = min(j, over);
+    for (int i = 1; i <= n; ++i) {
+        int from = max(1, i - maxEdits), to = min(m, i + maxEdits);
+        curr[from - 1] = (from == 1) ? min(i, over) : over;
+        int best = curr[from - 1];
+        for (int j = from; j <= to; ++j) {
+            int cost = prev[j - 1] + (a[i - 1] != b[j - 1]);
+            cost = min(cost, prev[j] + 1);
+            cost = min(cost, curr[j - 1] + 1);
+            curr[j] = min(cost, over);
+            best = min(best, curr[j]);
+        }
+        if (to < m) curr[to + 1] = over;
+        if (best > maxEdits) return over;
+        swap(prev, curr);
+    }
+    return prev[m];
+}
+
+void NameIndex::rebuild(const HotelTable& table)
+{
+    vector<uint32_t> counts(table.names().size(), 0), names(table.size());
+    for (size_t row = 0; row < names.size(); ++row) {
+        names[row] = table.isLive(row) ? table.nameId(row) : NamePool::NONE;
+        if (names[row] != NamePool::NONE) counts[names[row]]++;
+    }
+    liveRows.assign(counts.data(), counts.size());
+    rowNames.assign(names.data(), names.size());
+    sortedNames.rebuild(table);
+
+    rowGroups = nullptr;
+    suffixes = nullptr;
+    grams = nullptr;
+}
+
+void NameIndex::insert(const HotelTable& table, uint32_t row)
+{
+    if (rowNames.size() <= row) rowNames.resize(row + 1, NamePool::NONE);
+    update(table, row);
+}
+
+void NameIndex::remove(const HotelTable& table, uint32_t row)
+{
+    if (rowNames[row] != NamePool::NONE) dropName(table, rowNames[row]);
+    rowNames.set(row, NamePool::NONE);
+    rowGroups = nullptr;
+}
+
+void NameIndex::update(const HotelTable& table, uint32_t row)
+{
+    uint32_t nameId = table.nameId(row);
+    addName(table, nameId);
+    if (rowNames[row] != NamePool::NONE) dropName(table, rowNames[row]);
+    rowNames.set(row, nameId);
+    rowGroups = nullptr;
+}
+
+void NameIndex::addName(const HotelTable& table, uint32_t nameId)
+{
+    if (nameId >= liveRows.size()) {
+        // New to the pool, so the suffix array and trigram index lack it
+        liveRows.resize(table.names().size(), 0);
+        suffixes = nullptr;
+        grams = nullptr;
+    }
+    uint32_t count = liveRows[nameId];
+    liveRows.set(nameId, count + 1);
+    if (count == 0) sortedNames.insert(table, nameId);
+}
+
+void NameIndex::dropName(const HotelTable& table, uint32_t nameId)
+{
+    uint32_t count = liveRows[nameId] - 1;
+    liveRows.set(nameId, count);
+    if (count == 0) sortedNames.erase(table, nameId);
+}
+
+const NameIndex::RowGroups& NameIndex::buildRows() const
+{
+    if (auto built = atomic_load(&rowGroups)) return *built;
+    lock_guard<mutex> lock(buildLock);
+    if (auto built = atomic_load(&rowGroups)) return *built;   // Another reader built it meanwhile
+
+    auto groups = make_shared<RowGroups>();
+    groups->start.assign(liveRows.size() + 1, 0);
+    for (size_t row = 0; row < rowNames.size(); ++row) {
+        if (rowNames[row] != NamePool::NONE) groups->start[rowNames[row] + 1]++;
+    }
+    for (size_t i = 1; i < groups->start.size(); ++i) groups->start[i] += groups->start[i - 1];
+
+    groups->rows.resize(groups->start.back());
+    vector<uint32_t> fill(groups->start.begin(), groups->start.end() - 1);
+    for (uint32_t row = 0; row < rowNames.size(); ++row) {
+        if (rowNames[row] != NamePool::NONE) groups->rows[fill[rowNames[row]]++] = row;
+    }
+    atomic_store(&rowGroups, shared_ptr<const RowGroups>(groups));
+    return *groups;
+}
+
+RowSpan NameIndex::rowsOf(uint32_t nameId) const
+{
+    const RowGroups& groups = buildRows();
+    if (nameId + 1 >= groups.start.size()) return {};
+    return {groups.rows.data() + groups.start[nameId], groups.rows.data() + groups.start[nameId + 1]};
+}
+
+RowSpan NameIndex::exact(const HotelTable& table, string_view name) const
+{
+    uint32_t nameId = table.names().find(name);
+    return nameId == NamePool::NONE ? RowSpan() : rowsOf(nameId);
+}
+
+NameSpan NameIndex::prefix(const HotelTable& table, string_view text) const
+{
+    return sortedNames.startingWith(table, text);
+}
+
+const NameIndex::Suffixes& NameIndex::buildSuffixes(const HotelTable& table) const
+{
+    if (auto built = atomic_load(&suffixes)) return *built;
+    lock_guard<mutex> lock(buildLock);
+    if (auto built = atomic_load(&suffixes)) return *built;
+
+    const NamePool& pool = table.names();
+    auto sorted = make_shared<Suffixes>();
+    for (uint32_t id = 0; id < liveRows.size(); ++id) {
+        for (uint32_t offset = 0; offset < pool.name(id).size(); ++offset) sorted->push_back({id, offset});
+    }
+    auto suffix = [&](const pair<uint32_t, uint32_t>& s) { return string_view(pool.name(s.first)).substr(s.second); };
+    sort(sorted->begin(), sorted->end(), [&](const auto& a, const auto& b) { return suffix(a) < suffix(b); });
+    atomic_store(&suffixes, shared_ptr<const Suffixes>(sorted));
+    return *sorted;
+}
+
+void NameIndex::substring(const HotelTable& table, string_view text, vector<uint32_t>& nameIds, size_t limit) const
+{
+    nameIds.clear();
+    if (text.empty()) {
+        for (uint32_t id = 0; id < liveRows.size() && (!limit || nameIds.size() < limit); ++id) {
+            if (liveRows[id]) nameIds.push_back(id);
+        }
+        return;
+    }
+
+    const Suffixes& sorted = buildSuffixes(table);
+    const NamePool& pool = table.names();
+    auto suffix = [&](const pair<uint32_t, uint32_t>& s) { return string_view(pool.name(s.first)).substr(s.second); };
+    auto first = partition_point(sorted.begin(), sorted.end(), [&](const auto& s) { return suffix(s) < text; });
+    for (auto it = first; it != sorted.end() && startsWith(suffix(*it), text); ++it) {
+        if (liveRows[it->first]) nameIds.push_back(it->first);
+    }
+
+    sort(nameIds.begin(), nameIds.end());
+    nameIds.erase(unique(nameIds.begin(), nameIds.end()), nameIds.end());
+    if (limit && nameIds.size() > limit) nameIds.resize(limit);
+}
+
+const NameIndex::Grams& NameIndex::buildGrams(const HotelTable& table) const
+{
+    if (auto built = atomic_load(&grams)) return *built;
+    lock_guard<mutex> lock(buildLock);
+    if (auto built = atomic_load(&grams)) return *built;
+
+    const NamePool& pool = table.names();
+    vector<pair<uint32_t, uint32_t>> postings;     // (gram, name id)
+    vector<uint32_t> nameGrams;
+    for (uint32_t id = 0; id < liveRows.size(); ++id) {
+        trigrams(pool.name(id), nameGrams);
+        for (uint32_t gram : nameGrams) postings.push_back({gram, id});
+    }
+    sort(postings.begin(), postings.end());
+
+    auto index = make_shared<Grams>();
+    index->names.resize(postings.size());
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (index->keys.empty() || index->keys.back() != postings[i].first) {
+            index->keys.push_back(postings[i].first);
+            index->start.push_back(i);
+        }
+        index->names[i] = postings[i].second;
+    }
+    index->start.push_back(postings.size());
+    atomic_store(&grams, shared_ptr<const Grams>(index));
+    return *index;
+}
+
+void NameIndex::fuzzy(const HotelTable& table, string_view text, int maxEdits, vector<uint32_t>& nameIds, size_t limit) const
+{
+    const Grams& index = buildGrams(table);
+    const NamePool& pool = table.names();
+    vector<pair<int, uint32_t>> found;     // (distance, name id)
+    auto verify = [&](uint32_t id) {
+        if (!liveRows[id]) return;
+        int distance = boundedEditDistance(text, pool.name(id), maxEdits);
+        if (distance <= maxEdits) found.push_back({distance, id});
+    };
+
+    // Each edit destroys at most three of the query's distinct trigrams
+    vector<uint32_t> textGrams;
+    trigrams(text, textGrams);
+    int needed = (int)textGrams.size() - 3 * maxEdits;
+
+    if (needed <= 0) {
+        // The filter can't exclude anything; fall back to a length-filtered scan
+        for (uint32_t id = 0; id < liveRows.size(); ++id) {
+            if (abs((int)pool.name(id).size() - (int)text.size()) <= maxEdits) verify(id);
+        }
+    } else {
+        // Per-thread hit counters, all zero between calls
+        thread_local vector<uint16_t> hitCount;
+        if (hitCount.size() < liveRows.size()) hitCount.resize(liveRows.size(), 0);
+
+        vector<uint32_t> touched;
+        for (uint32_t gram : textGrams) {
+            auto key = lower_bound(index.keys.begin(), index.keys.end(), gram);
+            if (key == index.keys.end() || *key != gram) continue;
+            size_t k = key - index.keys.begin();
+            for (uint32_t i = index.start[k]; i < index.start[k + 1]; ++i) {
+                if (hitCount[index.names[i]]++ == 0) touched.push_back(index.names[i]);
+            }
+        }
+        for (uint32_t id : touched) {
+            if (hitCount[id] >= needed) verify(id);
+            hitCount[id] = 0;
+        }
+    }
+
+    sort(found.begin(), found.end());
+    nameIds.clear();
+    for (const auto& [distance, id] : found) {
+        if (limit && nameIds.size() == limit) break;
+        nameIds.push_back(id);
+    }
+}
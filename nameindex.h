@@ -0,0 +1,84 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "hoteltable.h"
+#include "hotelindex.h"
+using namespace std;
+
+// Stretch of NamePool ids in name order
+typedef IndexSpan NameSpan;
+
+// Name search over a HotelTable: exact lookup through the NamePool hash table, prefix search over
+// the distinct names of live rows in sorted order, substring search over a suffix array and bounded
+// edit-distance search filtered by a trigram index.
+// The row grouping, suffix array and trigram index are built on first use after names change. Const
+// methods may run concurrently (on a published HotelSnapshot); the lazy builds are double-checked
+// under a lock. The other members are chunked, and the built structures are shared until they go
+// stale, so a copy costs about a pointer per chunk.
+class NameIndex {
+public:
+    void rebuild(const HotelTable& table);
+    void insert(const HotelTable& table, uint32_t row);
+    void update(const HotelTable& table, uint32_t row);     // After the row's name changed
+    void remove(const HotelTable& table, uint32_t row);
+
+    RowSpan rowsOf(uint32_t nameId) const;                          // Rows carrying this name, ascending
+    RowSpan exact(const HotelTable& table, string_view name) const;
+    // Only names some live row carries are returned by the searches below
+    NameSpan prefix(const HotelTable& table, string_view text) const;   // Distinct names, sorted
+
+    // Distinct names containing text, at most limit of them (0 = no limit), in name id order
+    void substring(const HotelTable& table, string_view text, vector<uint32_t>& nameIds, size_t limit = 0) const;
+
+    // Distinct names within maxEdits Levenshtein edits of text, closest first, at most limit of them
+    void fuzzy(const HotelTable& table, string_view text, int maxEdits, vector<uint32_t>& nameIds, size_t limit = 0) const;
+
+private:
+    // Copyable stand-in for mutex, so NameIndex itself stays copyable
+    struct BuildLock : mutex {
+        BuildLock() = default;
+        BuildLock(const BuildLock&) {}
+        BuildLock& operator=(const BuildLock&) { return *this; }
+    };
+
+    // Rows grouped by name id (CSR)
+    struct RowGroups {
+        vector<uint32_t> start{0};
+        vector<uint32_t> rows;
+    };
+    // Trigram postings over padded names (CSR keyed by sorted gram)
+    struct Grams {
+        vector<uint32_t> keys;
+        vector<uint32_t> start;
+        vector<uint32_t> names;
+    };
+    // Suffix array: (name id, offset) pairs sorted by the suffix they start
+    typedef vector<pair<uint32_t, uint32_t>> Suffixes;
+
+    SortedIndex sortedNames{SortedIndex::NameId};   // Kept up to date on every change
+    ChunkedColumn<uint32_t> liveRows;   // Live rows per name id
+    ChunkedColumn<uint32_t> rowNames;   // Name id of every row seen so far, NamePool::NONE once removed
+
+    // Built on demand, null while stale. Readers go through atomic_load / atomic_store.
+    // The suffix array and trigram index cover every name id; searches skip names without live rows
+    mutable BuildLock buildLock;
+    mutable shared_ptr<const RowGroups> rowGroups;
+    mutable shared_ptr<const Suffixes> suffixes;
+    mutable shared_ptr<const Grams> grams;
+
+    void addName(const HotelTable& table, uint32_t nameId);
+    void dropName(const HotelTable& table, uint32_t nameId);
+    const RowGroups& buildRows() const;
+    const Suffixes& buildSuffixes(const HotelTable& table) const;
+    const Grams& buildGrams(const HotelTable& table) const;
+};
+
+// Levenshtein distance between a and b, or maxEdits + 1 once it is known to exceed maxEdits
+int boundedEditDistance(string_view a, string_view b, int maxEdits);
+
+#endif // NAMEINDEX_H
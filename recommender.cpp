@@ -0,0 +1,123 @@
+#include "recommender.h"
+#include "asyncjob.h"
+#include "metrics.h"
+#include <algorithm>
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Budgets below this many cells per item run on one thread; dispatch would cost more than it saves
+const int PARALLEL_CELLS = 1 << 16;
+
+inline void setBits(uint64_t* bits, int w, uint64_t mask)
+{
+    // Only touch the next word when bits actually spill into it, so threads on
+    // neighbouring 64-aligned chunks never read-modify-write the same word
+    int shift = w & 63;
+    bits[w >> 6] |= mask << shift;
+    if (shift && (mask >> (64 - shift))) bits[(w >> 6) + 1] |= mask >> (64 - shift);
+}
+
+// For w in [from, to): curr[w] = max(prev[w], prev[w - price] + rating), marking strict improvements
+void relaxRange(const float* prev, float* curr, uint64_t* taken, int price, float rating, int from, int to)
+{
+    int w = from;
+#if defined(__AVX__)
+    __m256 vr = _mm256_set1_ps(rating);
+    for (; w + 8 <= to; w += 8) {
+        __m256 keep = _mm256_loadu_ps(prev + w);
+        __m256 take = _mm256_add_ps(_mm256_loadu_ps(prev + w - price), vr);
+        __m256 better = _mm256_cmp_ps(take, keep, _CMP_GT_OQ);
+        _mm256_storeu_ps(curr + w, _mm256_blendv_ps(keep, take, better));
+        int mask = _mm256_movemask_ps(better);
+        if (mask) setBits(taken, w, mask);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 vr = _mm_set1_ps(rating);
+    for (; w + 4 <= to; w += 4) {
+        __m128 keep = _mm_loadu_ps(prev + w);
+        __m128 take = _mm_add_ps(_mm_loadu_ps(prev + w - price), vr);
+        __m128 better = _mm_cmpgt_ps(take, keep);
+        _mm_storeu_ps(curr + w, _mm_or_ps(_mm_and_ps(better, take), _mm_andnot_ps(better, keep)));
+        int mask = _mm_movemask_ps(better);
+        if (mask) setBits(taken, w, mask);
+    }
+#endif
+    for (; w < to; ++w) {
+        float take = prev[w - price] + rating;
+        if (take > prev[w]) {
+            curr[w] = take;
+            taken[w >> 6] |= uint64_t(1) << (w & 63);
+        } else {
+            curr[w] = prev[w];
+        }
+    }
+}
+
+} // namespace
+
+KnapsackResult Recommender::bestCombination(const HotelTable& table, int budget, float minRating, JobControl* job) const
+{
+    KnapsackResult result;
+    if (budget < 0) return result;
+    METRIC_TIMER(Knapsack);
+
+    // Hotels failing the rating or unaffordable on the whole budget never change a DP row, so drop them up front
+    HotelFilter filter;
+    filter.minPrice = 0;
+    filter.maxPrice = budget;
+    filter.minRating = minRating;
+    vector<uint32_t> items;
+    filterHotels(table, filter, items);
+
+    int cells = budget + 1;
+    size_t words = (cells + 63) / 64 + 1;  // One spare word for setBits straddling the end
+    vector<float> prev(cells, 0), curr(cells, 0);
+    vector<uint64_t> taken(items.size() * words, 0);
+    METRIC_ADD(BufferAllocations, 3);
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (job) {
+            if (job->isCancelled()) return result;
+            job->progress(i, items.size());
+        }
+        int price = table.price(items[i]);
+        float rating = table.rating(items[i]);
+        uint64_t* bits = taken.data() + i * words;
+
+        // Cells below the price (and cell 0, which the original loop never filled) carry over
+        int first = max(price, 1);
+        copy(prev.begin(), prev.begin() + min(first, cells), curr.begin());
+
+        int span = cells - first;
+        if (span >= PARALLEL_CELLS && pool && pool->size() > 1) {
+            // Chunk boundaries sit on multiples of 64 cells so no two threads share a bit word
+            int chunk = ((cells / pool->size()) + 63) & ~63;
+            int chunks = (cells + chunk - 1) / chunk;
+            pool->parallelFor(chunks, [&](int c) {
+                int from = max(first, c * chunk);
+                int to = min(cells, (c + 1) * chunk);
+                if (from < to) relaxRange(prev.data(), curr.data(), bits, price, rating, from, to);
+            });
+        } else if (span > 0) {
+            relaxRange(prev.data(), curr.data(), bits, price, rating, first, cells);
+        }
+        prev.swap(curr);
+    }
+    METRIC_ADD(DpCells, (uint64_t)items.size() * cells);
+
+    result.totalRating = prev[budget];
+    int w = budget;
+    for (size_t i = items.size(); i > 0 && w > 0; --i) {
+        const uint64_t* bits = taken.data() + (i - 1) * words;
+        if (bits[w >> 6] >> (w & 63) & 1) {
+            result.rows.push_back(items[i - 1]);
+            result.totalCost += table.price(items[i - 1]);
+            w -= table.price(items[i - 1]);
+        }
+    }
+    reverse(result.rows.begin(), result.rows.end());
+    return result;
+}
@@ -0,0 +1,33 @@
+#ifndef RECOMMENDER_H
+#define RECOMMENDER_H
+
+#include <cstdint>
+#include <vector>
+#include "hoteltable.h"
+#include "threadpool.h"
+using namespace std;
+
+class JobControl;
+
+struct KnapsackResult {
+    float totalRating = 0;
+    int totalCost = 0;
+    vector<uint32_t> rows;      // Selected table rows, ascending
+};
+
+// Hotel recommendation engine
+class Recommender {
+public:
+    explicit Recommender(ThreadPool* pool = &ThreadPool::shared()) : pool(pool) {}
+
+    // 0/1 knapsack: the set of hotels rated at least minRating with the highest total rating
+    // whose prices fit in budget. Same recurrence and tie-breaking as the full (n+1) x (budget+1)
+    // table, but with two rolling rows plus one bit per cell to reconstruct the choice.
+    // A cancelled job returns an empty result.
+    KnapsackResult bestCombination(const HotelTable& table, int budget, float minRating, JobControl* job = nullptr) const;
+
+private:
+    ThreadPool* pool;
+};
+
+#endif // RECOMMENDER_H
@@ -0,0 +1,77 @@
+#include "routebatch.h"
+#include "asyncjob.h"
+#include <algorithm>
+#include <atomic>
+
+void RouteMatrix::reset(const vector<RouteQuery>& queries, bool paths)
+{
+    keepPaths = paths;
+    table.resize(queries.size());
+    for (size_t r = 0; r < queries.size(); ++r) {
+        Row& row = table[r];
+        row.dist.assign(queries[r].targets.size(), GraphCore::INF);
+        row.pathEnd.assign(keepPaths ? queries[r].targets.size() : 0, 0);
+        row.hops.clear();
+    }
+}
+
+void RouteMatrix::fill(size_t r, size_t column, float distance, const vector<int>& path)
+{
+    Row& row = table[r];
+    row.dist[column] = distance;
+    if (!keepPaths) return;
+    row.hops.insert(row.hops.end(), path.begin(), path.end());
+    row.pathEnd[column] = row.hops.size();
+}
+
+bool RouteMatrix::path(size_t r, size_t column, vector<int>& out) const
+{
+    out.clear();
+    const Row& row = table[r];
+    if (!keepPaths || row.dist[column] >= GraphCore::INF) return false;
+
+    uint32_t begin = column ? row.pathEnd[column - 1] : 0;
+    out.assign(row.hops.begin() + begin, row.hops.begin() + row.pathEnd[column]);
+    return true;
+}
+
+bool routeBatch(const GraphCore& graph, const vector<RouteQuery>& queries, RouteMatrix& result,
+                bool keepPaths, ThreadPool* pool, JobControl* job)
+{
+    result.reset(queries, keepPaths);
+    int n = graph.cityCount();
+    graph.offsets();    // Builds the CSR here, before the searches share it
+
+    atomic<size_t> finished{0};
+    auto runQuery = [&](int q) {
+        if (job && job->isCancelled()) return;
+
+        // Reused by every query this thread runs, in this batch and later ones
+        QueryContext& context = QueryContext::local();
+        SearchScratch& scratch = context.forward;
+        vector<int>& path = context.path;
+
+        const RouteQuery& query = queries[q];
+        if (query.source >= 0 && query.source < n) {
+            graph.searchMany(query.source, query.targets.data(), query.targets.size(), scratch);
+            for (size_t c = 0; c < query.targets.size(); ++c) {
+                int target = query.targets[c];
+                float dist = target >= 0 && target < n ? scratch.dist[target] : GraphCore::INF;
+                path.clear();
+                if (keepPaths && dist < GraphCore::INF) {
+                    for (int at = target; at != -1; at = scratch.prev[at]) {
+                        path.push_back(at);
+                        if (at == query.source) break;
+                    }
+                    reverse(path.begin(), path.end());
+                }
+                result.fill(q, c, dist, path);
+            }
+        }
+        if (job) job->progress(++finished, queries.size());
+    };
+
+    if (pool) pool->parallelFor(queries.size(), runQuery);
+    else for (size_t q = 0; q < queries.size(); ++q) runQuery(q);
+    return !(job && job->isCancelled());
+}
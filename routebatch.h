@@ -0,0 +1,53 @@
+#ifndef ROUTEBATCH_H
+#define ROUTEBATCH_H
+
+#include <cstdint>
+#include <vector>
+#include "graphcore.h"
+#include "threadpool.h"
+using namespace std;
+
+class JobControl;
+
+// One source and the targets to route it to, by city id. Ids outside the graph come back unreachable.
+struct RouteQuery {
+    int source;
+    vector<int> targets;
+};
+
+// Results of a batch: one row per query, one cell per target, in query order
+class RouteMatrix {
+public:
+    size_t rows() const { return table.size(); }
+    size_t columns(size_t row) const { return table[row].dist.size(); }
+    bool hasPaths() const { return keepPaths; }
+
+    float distance(size_t row, size_t column) const { return table[row].dist[column]; }   // INF when unreachable
+
+    // City ids from source to target; false when unreachable or the batch did not keep paths
+    bool path(size_t row, size_t column, vector<int>& out) const;
+
+    // Sizes the matrix for queries with every cell unreachable
+    void reset(const vector<RouteQuery>& queries, bool keepPaths);
+
+    // Sets one cell; cells of a row are filled in column order, and different rows may be
+    // filled from different threads. path is ignored unless the matrix keeps paths.
+    void fill(size_t row, size_t column, float distance, const vector<int>& path);
+
+private:
+    struct Row {
+        vector<float> dist;
+        vector<uint32_t> pathEnd;   // Cell c's path is hops[pathEnd[c - 1] .. pathEnd[c])
+        vector<int> hops;
+    };
+    vector<Row> table;
+    bool keepPaths = false;
+};
+
+// Runs one one-to-many search per query, spread over the pool; each thread keeps its own
+// QueryContext between queries and batches. Returns false if job was cancelled part way,
+// in which case the rows not reached stay unreachable.
+bool routeBatch(const GraphCore& graph, const vector<RouteQuery>& queries, RouteMatrix& result,
+                bool keepPaths = true, ThreadPool* pool = &ThreadPool::shared(), JobControl* job = nullptr);
+
+#endif // ROUTEBATCH_H
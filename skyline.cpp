@@ -0,0 +1,164 @@
+#include "skyline.h"
+#include "metrics.h"
+#include <algorithm>
+#include <map>
+
+namespace {
+
+// Inputs smaller than this are swept on one thread
+const size_t PARALLEL_ROWS = 1 << 16;
+
+// Appends the rows of [first, last) that match filter and that no earlier matching row dominates.
+// Rows must be in ascending price order.
+template <typename Iterator>
+void sweep(const HotelTable& table, Iterator first, Iterator last, const HotelFilter& filter, vector<uint32_t>& out)
+{
+    // Rating -> shortest distance among kept rows rated at least that; distance rises with rating, so
+    // the entry at the lowest rating >= r holds the closest kept hotel rated r or better
+    map<float, float> staircase;
+    vector<uint32_t> group;
+    size_t lastKept = SIZE_MAX;
+
+    auto byRatingThenDistance = [&](uint32_t a, uint32_t b) {
+        if (table.rating(a) != table.rating(b)) return table.rating(a) > table.rating(b);
+        if (table.distance(a) != table.distance(b)) return table.distance(a) < table.distance(b);
+        return a < b;
+    };
+
+    // Whether some kept row is rated at least as high and no farther
+    auto covered = [&](float rating, float distance) {
+        auto cover = staircase.lower_bound(rating);
+        return cover != staircase.end() && cover->second <= distance;
+    };
+
+    for (Iterator at = first; at != last;) {
+        // The next run of matching rows at one price that no cheaper kept row covers (and so dominates),
+        // best rated first. Most rows fall here, so only the few survivors get sorted.
+        int price = table.price(*at);
+        group.clear();
+        for (; at != last && table.price(*at) == price; ++at) {
+            float rating = table.rating(*at), distance = table.distance(*at);
+            if (filter.matches(price, rating, distance) && !covered(rating, distance)) group.push_back(*at);
+        }
+        if (group.size() > 1) sort(group.begin(), group.end(), byRatingThenDistance);
+
+        for (uint32_t row : group) {
+            float rating = table.rating(row), distance = table.distance(row);
+            bool twin = lastKept != SIZE_MAX && table.price(lastKept) == price
+                        && table.rating(lastKept) == rating && table.distance(lastKept) == distance;
+            if (!twin) {
+                // Now a same-priced row rated at least as high and no farther, and not a twin, dominates
+                if (covered(rating, distance)) continue;
+
+                // Lower-rated steps no closer than this row no longer matter
+                auto step = staircase.insert_or_assign(rating, distance).first;
+                while (step != staircase.begin() && prev(step)->second >= distance) staircase.erase(prev(step));
+            }
+            out.push_back(row);
+            lastKept = row;
+        }
+    }
+}
+
+// Ascending price, remaining ties by row
+struct PriceOrder {
+    const HotelTable& table;
+    bool operator()(uint32_t a, uint32_t b) const {
+        return table.price(a) != table.price(b) ? table.price(a) < table.price(b) : a < b;
+    }
+};
+
+// Runs body(run, from, to) over count rows cut into one run per pool thread, or a single run
+// when the input is small
+template <typename Body>
+size_t forEachRun(size_t count, ThreadPool* pool, Body body)
+{
+    size_t runs = pool && pool->size() > 1 && count >= PARALLEL_ROWS ? pool->size() : 1;
+    if (runs == 1) {
+        body(0, 0, count);
+        return 1;
+    }
+    size_t per = (count + runs - 1) / runs;
+    pool->parallelFor(runs, [&](int r) { body(r, min(count, r * per), min(count, (r + 1) * per)); });
+    return runs;
+}
+
+// Sweeps the runs' fronts together; each is a superset of its run's share of the whole front
+void mergeFronts(const HotelTable& table, vector<vector<uint32_t>>& fronts, bool inPriceOrder, vector<uint32_t>& rows)
+{
+    if (fronts.size() == 1) {
+        rows.swap(fronts[0]);
+        return;
+    }
+    vector<uint32_t> merged;
+    for (const auto& front : fronts) merged.insert(merged.end(), front.begin(), front.end());
+    if (!inPriceOrder) sort(merged.begin(), merged.end(), PriceOrder{table});
+    sweep(table, merged.data(), merged.data() + merged.size(), HotelFilter(), rows);
+}
+
+} // namespace
+
+void skyline(const HotelTable& table, const HotelFilter& filter, vector<uint32_t>& rows, ThreadPool* pool)
+{
+    METRIC_TIMER(Skyline);
+    vector<uint32_t> matching;
+    filterHotels(table, filter, matching);
+    rows.clear();
+
+    // Each run is sorted and swept on its own thread; the fronts then need one more sort
+    vector<vector<uint32_t>> fronts(pool ? max(1u, pool->size()) : 1);
+    size_t runs = forEachRun(matching.size(), pool, [&](size_t r, size_t from, size_t to) {
+        sort(matching.begin() + from, matching.begin() + to, PriceOrder{table});
+        sweep(table, matching.data() + from, matching.data() + to, HotelFilter(), fronts[r]);
+    });
+    fronts.resize(runs);
+    mergeFronts(table, fronts, false, rows);
+}
+
+void skyline(const HotelTable& table, IndexSpan byPrice, const HotelFilter& filter, vector<uint32_t>& rows,
+             ThreadPool* pool)
+{
+    METRIC_TIMER(Skyline);
+    rows.clear();
+
+    // Runs are contiguous stretches of the index, so their fronts concatenate in price order
+    vector<vector<uint32_t>> fronts(pool ? max(1u, pool->size()) : 1);
+    size_t runs = forEachRun(byPrice.size(), pool, [&](size_t r, size_t from, size_t to) {
+        IndexSpan run = byPrice.slice(from, to);
+        sweep(table, run.begin(), run.end(), filter, fronts[r]);
+    });
+    fronts.resize(runs);
+    mergeFronts(table, fronts, true, rows);
+}
+
+void rankSkyline(const HotelTable& table, const SkylineWeights& weights, vector<uint32_t>& rows)
+{
+    if (rows.size() < 2) return;
+
+    float minPrice = table.price(rows[0]), maxPrice = minPrice;
+    float minRating = table.rating(rows[0]), maxRating = minRating;
+    float minDistance = table.distance(rows[0]), maxDistance = minDistance;
+    for (uint32_t row : rows) {
+        minPrice = min<float>(minPrice, table.price(row));
+        maxPrice = max<float>(maxPrice, table.price(row));
+        minRating = min(minRating, table.rating(row));
+        maxRating = max(maxRating, table.rating(row));
+        minDistance = min(minDistance, table.distance(row));
+        maxDistance = max(maxDistance, table.distance(row));
+    }
+
+    // An attribute every row shares scores 1 for all of them
+    auto scaled = [](float value, float worst, float best) {
+        return worst == best ? 1.0f : (value - worst) / (best - worst);
+    };
+    vector<pair<float, uint32_t>> scored;
+    scored.reserve(rows.size());
+    for (uint32_t row : rows) {
+        float score = weights.price * scaled(table.price(row), maxPrice, minPrice)
+                      + weights.rating * scaled(table.rating(row), minRating, maxRating)
+                      + weights.distance * scaled(table.distance(row), maxDistance, minDistance);
+        scored.push_back({score, row});
+    }
+    stable_sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < rows.size(); ++i) rows[i] = scored[i].second;
+}
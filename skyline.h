@@ -0,0 +1,39 @@
+#ifndef SKYLINE_H
+#define SKYLINE_H
+
+#include <cstdint>
+#include <vector>
+#include "hoteltable.h"
+#include "hotelindex.h"
+#include "threadpool.h"
+using namespace std;
+
+// One hotel dominates another when it is no dearer, no worse rated and no farther, and strictly
+// better on at least one of the three. The skyline (Pareto front) is every hotel nothing dominates.
+//
+// Sort-first: in ascending price order (rating high to low, then distance, within a price) a hotel
+// can only be dominated by one before it, so one sweep decides each hotel against a staircase of
+// the (rating, distance) pairs kept so far, in O(log front). Large inputs are split into runs
+// swept in parallel; a run's front is a superset of its share of the whole front, so a last sweep
+// over the concatenated fronts finishes the job. Hotels with identical attributes are all kept.
+
+// Skyline of the rows matching filter, in ascending price order
+void skyline(const HotelTable& table, const HotelFilter& filter, vector<uint32_t>& rows,
+             ThreadPool* pool = &ThreadPool::shared());
+
+// The same from the live rows already in price order (SortedIndex::Price), which skips the sort
+void skyline(const HotelTable& table, IndexSpan byPrice, const HotelFilter& filter, vector<uint32_t>& rows,
+             ThreadPool* pool = &ThreadPool::shared());
+
+// Relative importance of each attribute when ranking a skyline
+struct SkylineWeights {
+    float price = 1;
+    float rating = 1;
+    float distance = 1;
+};
+
+// Orders rows best first by weighted score. Each attribute is scaled to [0, 1] across rows,
+// 1 being the cheapest, best rated or closest among them; ties keep their current order.
+void rankSkyline(const HotelTable& table, const SkylineWeights& weights, vector<uint32_t>& rows);
+
+#endif // SKYLINE_H
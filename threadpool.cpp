@@ -0,0 +1,95 @@
+#include "threadpool.h"
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    if (threadCount == 0) threadCount = 1;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        tasks.push_back(move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int)>& body)
+{
+    if (count <= 0) return;
+    if (count == 1 || workers.size() <= 1) {
+        for (int i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    // Completion is tracked per index rather than per helper, so helpers that start
+    // after the work is gone just exit; the shared state outlives this call for them.
+    struct State {
+        atomic<int> next{0};
+        atomic<int> done{0};
+        int count;
+        const function<void(int)>* body;
+        mutex lock;
+        condition_variable finished;
+    };
+    auto state = make_shared<State>();
+    state->count = count;
+    state->body = &body;
+
+    auto run = [](State& s) {
+        int ran = 0;
+        for (int i = s.next++; i < s.count; i = s.next++) {
+            (*s.body)(i);
+            ++ran;
+        }
+        if (ran > 0 && (s.done += ran) == s.count) {
+            lock_guard<mutex> guard(s.lock);
+            s.finished.notify_all();
+        }
+    };
+
+    int helpers = min<int>(workers.size(), count - 1);
+    for (int h = 0; h < helpers; ++h) {
+        submit([state, run] { run(*state); });
+    }
+    run(*state);
+
+    unique_lock<mutex> guard(state->lock);
+    state->finished.wait(guard, [&] { return state->done == count; });
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,41 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+using namespace std;
+
+// Fixed-size worker pool shared by the parallel query engines
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return workers.size(); }
+
+    void submit(function<void()> task);
+
+    // Runs body(0..count-1) across the pool and returns when every index is done.
+    // The calling thread takes part, so nested calls from a worker cannot deadlock.
+    void parallelFor(int count, const function<void(int)>& body);
+
+    static ThreadPool& shared();
+
+private:
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+#endif // THREADPOOL_H
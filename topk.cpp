@@ -0,0 +1,58 @@
+#include "topk.h"
+#include <algorithm>
+
+bool RowOrder::operator()(uint32_t a, uint32_t b) const
+{
+    for (const SortKey& key : keys) {
+        float x, y;
+        switch (key.attribute) {
+        case SortKey::Price: x = table.price(a); y = table.price(b); break;
+        case SortKey::Rating: x = table.rating(a); y = table.rating(b); break;
+        case SortKey::Distance: x = table.distance(a); y = table.distance(b); break;
+        default:
+            if (table.id(a) == table.id(b)) continue;
+            return key.descending ? table.id(a) > table.id(b) : table.id(a) < table.id(b);
+        }
+        if (x != y) return key.descending ? x > y : x < y;
+    }
+    return a < b;
+}
+
+void topK(const HotelTable& table, const vector<SortKey>& keys, size_t k, const HotelFilter& filter,
+          vector<uint32_t>& rows)
+{
+    rows.clear();
+    if (k == 0) return;
+
+    RowOrder before(table, keys);
+    vector<uint64_t> selected;
+    filterHotels(table, filter, selected);
+
+    if (k * 8 >= table.size()) {
+        // Most of the table is wanted anyway: partial selection beats heap churn
+        bitmapToRows(selected, rows);
+        if (rows.size() > k) {
+            nth_element(rows.begin(), rows.begin() + k, rows.end(), before);
+            rows.resize(k);
+        }
+        sort(rows.begin(), rows.end(), before);
+        return;
+    }
+
+    // Max-heap (under `before`) of the best k seen so far; its top is the one to evict
+    rows.reserve(k);
+    for (size_t w = 0; w < selected.size(); ++w) {
+        for (uint64_t word = selected[w]; word; word &= word - 1) {
+            uint32_t row = w * 64 + lowestBit(word);
+            if (rows.size() < k) {
+                rows.push_back(row);
+                push_heap(rows.begin(), rows.end(), before);
+            } else if (before(row, rows.front())) {
+                pop_heap(rows.begin(), rows.end(), before);
+                rows.back() = row;
+                push_heap(rows.begin(), rows.end(), before);
+            }
+        }
+    }
+    sort_heap(rows.begin(), rows.end(), before);
+}
@@ -0,0 +1,33 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <cstdint>
+#include <vector>
+#include "hoteltable.h"
+using namespace std;
+
+// One level of a compound ordering, e.g. {Rating, true} then {Price, false}
+struct SortKey {
+    enum Attribute { Price, Rating, Distance, Id };
+
+    Attribute attribute;
+    bool descending = false;
+};
+
+// Strict weak order over table rows for a compound key; remaining ties go to the lower row
+class RowOrder {
+public:
+    RowOrder(const HotelTable& table, const vector<SortKey>& keys) : table(table), keys(keys) {}
+    bool operator()(uint32_t a, uint32_t b) const;
+
+private:
+    const HotelTable& table;
+    const vector<SortKey>& keys;
+};
+
+// The first k rows matching filter under the given ordering, in order.
+// Small k keeps a bounded heap (O(n log k)); large k selects with nth_element and sorts the head.
+void topK(const HotelTable& table, const vector<SortKey>& keys, size_t k, const HotelFilter& filter,
+          vector<uint32_t>& rows);
+
+#endif // TOPK_H